@@ -3,7 +3,10 @@
  * This version includes professional techniques for jitter reduction:
  * - SCHED_FIFO scheduler policy
  * - Pinning the thread to a specific CPU core (CPU affinity)
- * - Locking memory to prevent page faults (mlockall)
+ * - Locking memory to prevent page faults (mlockall, stack and heap prefault via rtmem)
+ *
+ * Usage: sched_fifo_jitter [-s]
+ *   -s  lock only the stack, heap reserve and program/library images instead of mlockall (smaller RSS)
  */
 
 #define _POSIX_C_SOURCE 200809L
@@ -15,9 +18,13 @@
 #include <stdlib.h>
 #include <string.h>
 #include <sys/mman.h>
+#include <sys/resource.h>
 #include <time.h>
 #include <unistd.h>
 
+#include "memaudit.h"
+#include "rtmem.h"
+
 #ifndef __linux__
 int main(void) {
     printf("sched_fifo_jitter: Linux-only example (SCHED_FIFO not available)\n");
@@ -41,7 +48,7 @@ static inline void ns_to_ts(int64_t ns, struct timespec *ts) {
     ts->tv_nsec = (long)(ns % 1000000000LL);
 }
 
-int main(void) {
+int main(int argc, char **argv) {
     setvbuf(stdout, NULL, _IOLBF, 0);
 
     int max_prio = sched_get_priority_max(SCHED_FIFO);
@@ -54,11 +61,25 @@ int main(void) {
         printf("Switched to SCHED_FIFO priority %d\n", sp.sched_priority);
     }
 
-    //2. Блокировка памяти
-    if (mlockall(MCL_CURRENT | MCL_FUTURE) != 0) {
-        perror("WARNING: mlockall failed");
+    //2. Блокировка памяти, настройка malloc, prefault стека и резерв кучи.
+    // С -s rtmem блокирует только стек и резерв кучи. Код и данные программы, libc и
+    // qsort цикл тоже касается: их блокирует проверка памяти ниже
+    int selective = argc > 1 && strcmp(argv[1], "-s") == 0;
+    RtMemOptions rt_opts = {.flags = selective ? RTMEM_SELECTIVE : 0};
+    if (rtmem_init(&rt_opts) != 0) {
+        perror("WARNING: memory locking failed");
+    } else if (selective) {
+        printf("Locked and prefaulted stack and heap reserve only\n");
     } else {
-        printf("Locked process memory with mlockall()\n");
+        printf("Locked process memory with mlockall(), prefaulted stack and heap\n");
+    }
+
+    // Проверка перед циклом: все, чего касается цикл, в RAM и заблокировано.
+    // В выборочном режиме это заблокированные отображения и образы программы и
+    // библиотек (vDSO ядро держит в RAM само)
+    unsigned audit_flags = MEMAUDIT_FIX | MEMAUDIT_QUIET | (selective ? MEMAUDIT_LOCKED_ONLY : 0);
+    if (memaudit_run(audit_flags, stdout, NULL) != 0) {
+        printf("WARNING: memory audit found ranges that could not be locked\n");
     }
 
     //3. Привязка к одному CPU
@@ -80,6 +101,10 @@ int main(void) {
 
     struct timespec next;
     clock_gettime(CLOCK_MONOTONIC, &next);
+
+    // Первый вызов clock_gettime касается страницы vDSO-данных; он уже позади
+    struct rusage usage_before, usage_after;
+    getrusage(RUSAGE_SELF, &usage_before);
     int64_t next_ns = ts_to_ns(&next) + period;
 
     for (int i = 0; i < samples; ++i) {
@@ -98,6 +123,7 @@ int main(void) {
         deltas[i] = ts_to_ns(&now) - next_ns;
         next_ns += period;
     }
+    getrusage(RUSAGE_SELF, &usage_after);
 
     // Анализ статистики
     qsort(deltas, samples, sizeof(int64_t), compare_i64);
@@ -114,6 +140,9 @@ int main(void) {
     printf("  avg latency: %.1f ns\n", avg);
     printf("  99th percentile: %" PRId64 " ns\n", p99);
     printf("  max latency: %" PRId64 " ns\n", max);
+    printf("  page faults during measurement: %ld minor, %ld major\n",
+           usage_after.ru_minflt - usage_before.ru_minflt, usage_after.ru_majflt - usage_before.ru_majflt);
+    printf("  peak RSS: %ld KB\n", usage_after.ru_maxrss);
 
     return 0;
 }
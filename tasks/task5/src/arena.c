@@ -0,0 +1,90 @@
+#define _GNU_SOURCE
+#include "arena.h"
+#include <stdalign.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+struct Arena {
+    char* start;
+    size_t capacity;
+    size_t mapped_size;
+    size_t offset; // Смещение первого свободного байта
+    size_t peak;
+};
+
+Arena* arena_create(size_t capacity) {
+    if (capacity == 0) return NULL;
+
+    Arena* arena = (Arena*)malloc(sizeof(Arena));
+    if (!arena) return NULL;
+
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    arena->mapped_size = (capacity + page - 1) & ~(page - 1);
+    arena->start = mmap(NULL, arena->mapped_size, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (arena->start == MAP_FAILED) {
+        free(arena);
+        return NULL;
+    }
+
+    // Заблокировать область и прогреть каждую страницу до начала RT-цикла
+    mlock(arena->start, arena->mapped_size);
+    for (size_t off = 0; off < arena->mapped_size; off += page) {
+        ((volatile char*)arena->start)[off] = 0;
+    }
+
+    arena->capacity = capacity;
+    arena->offset = 0;
+    arena->peak = 0;
+    return arena;
+}
+
+void* arena_alloc_aligned(Arena* arena, size_t size, size_t align) {
+    if (!arena || align == 0 || (align & (align - 1)) != 0) {
+        return NULL;
+    }
+
+    // Выравнивается адрес, а не смещение: начало области выровнено только по странице
+    uintptr_t base = (uintptr_t)arena->start;
+    uintptr_t aligned = (base + arena->offset + align - 1) & ~(uintptr_t)(align - 1);
+    size_t offset = (size_t)(aligned - base);
+    if (offset > arena->capacity || size > arena->capacity - offset) {
+        return NULL;
+    }
+
+    arena->offset = offset + size;
+    if (arena->offset > arena->peak) {
+        arena->peak = arena->offset;
+    }
+    return (void*)aligned;
+}
+
+void* arena_alloc(Arena* arena, size_t size) {
+    return arena_alloc_aligned(arena, size, alignof(max_align_t));
+}
+
+ArenaMark arena_mark(const Arena* arena) {
+    return arena ? arena->offset : 0;
+}
+
+void arena_rollback(Arena* arena, ArenaMark mark) {
+    if (!arena || mark > arena->offset) return;
+    arena->offset = mark;
+}
+
+void arena_reset(Arena* arena) {
+    if (!arena) return;
+    arena->offset = 0;
+}
+
+size_t arena_peak(const Arena* arena) {
+    return arena ? arena->peak : 0;
+}
+
+void arena_destroy(Arena* arena) {
+    if (!arena) return;
+    munmap(arena->start, arena->mapped_size);
+    free(arena);
+}
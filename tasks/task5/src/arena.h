@@ -0,0 +1,87 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+
+/*
+ * Арена (frame-аллокатор) для короткоживущей памяти одного цикла RT-задачи.
+ *
+ * Память выделяется сдвигом указателя, отдельных освобождений нет: в конце
+ * цикла вся арена сбрасывается за O(1) через arena_reset(), а вложенные
+ * участки можно откатить к сохраненной отметке (arena_mark/arena_rollback).
+ * Область арены блокируется и прогревается при создании.
+ */
+
+typedef struct Arena Arena;
+
+/** Отметка текущей позиции арены для arena_rollback(). */
+typedef size_t ArenaMark;
+
+/**
+ * @brief Создает арену.
+ *
+ * @param capacity Размер области в байтах.
+ * @return Указатель на арену или NULL в случае ошибки.
+ */
+Arena* arena_create(size_t capacity);
+
+/**
+ * @brief Выделяет size байт с выравниванием по alignof(max_align_t).
+ *
+ * @param arena Указатель на арену.
+ * @param size Размер в байтах.
+ * @return Указатель на память или NULL, если арена заполнена.
+ */
+void* arena_alloc(Arena* arena, size_t size);
+
+/**
+ * @brief Выделяет size байт с заданным выравниванием.
+ *
+ * @param arena Указатель на арену.
+ * @param size Размер в байтах.
+ * @param align Выравнивание (степень двойки).
+ * @return Указатель на память или NULL, если арена заполнена.
+ */
+void* arena_alloc_aligned(Arena* arena, size_t size, size_t align);
+
+/**
+ * @brief Запоминает текущую позицию арены.
+ *
+ * @param arena Указатель на арену.
+ * @return Отметка для arena_rollback().
+ */
+ArenaMark arena_mark(const Arena* arena);
+
+/**
+ * @brief Освобождает все, что было выделено после отметки.
+ *
+ * @param arena Указатель на арену.
+ * @param mark Отметка, полученная от arena_mark().
+ */
+void arena_rollback(Arena* arena, ArenaMark mark);
+
+/**
+ * @brief Освобождает всю память арены за O(1) (конец цикла).
+ *
+ * @param arena Указатель на арену.
+ */
+void arena_reset(Arena* arena);
+
+/**
+ * @brief Возвращает максимальное заполнение арены с момента создания.
+ *
+ * Помогает подобрать capacity под худший цикл.
+ *
+ * @param arena Указатель на арену.
+ * @return Пиковое количество занятых байт.
+ */
+size_t arena_peak(const Arena* arena);
+
+/**
+ * @brief Уничтожает арену.
+ *
+ * @param arena Указатель на арену.
+ */
+void arena_destroy(Arena* arena);
+
+#endif // ARENA_H
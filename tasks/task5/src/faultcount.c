@@ -0,0 +1,160 @@
+#define _GNU_SOURCE
+#include "faultcount.h"
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+#define RING_DATA_PAGES 8 // Степень двойки; 32 КБ — 4096 записей по 8 байт
+
+// Одно программное событие perf и его кольцевой буфер
+typedef struct {
+    int fd;
+    struct perf_event_mmap_page* page; // NULL — чтение через read()
+    size_t mapped_size;
+    const char* data;
+    uint64_t data_mask;
+    uint64_t tail;  // Позиция, до которой записи уже посчитаны
+    uint64_t count;
+} FaultEvent;
+
+struct FaultCounter {
+    FaultCountMethod method;
+    FaultEvent minor;
+    FaultEvent major;
+};
+
+static int event_open(FaultEvent* ev, uint64_t config, FaultCountMethod method) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_SOFTWARE;
+    attr.config = config;
+    // Только пользовательский режим: так событие доступно и при perf_event_paranoid = 2
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    if (method == FAULTCOUNT_RING) {
+        // Запись на каждый отказ, только заголовок (sample_type = 0)
+        attr.sample_period = 1;
+        attr.sample_type = 0;
+    }
+
+    ev->fd = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, PERF_FLAG_FD_CLOEXEC);
+    if (ev->fd < 0) return -1;
+    if (method != FAULTCOUNT_RING) return 0;
+
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t data_size = RING_DATA_PAGES * page;
+    // PROT_WRITE нужен, чтобы сообщать ядру data_tail; иначе буфер перезаписывается без учета
+    void* map = mmap(NULL, page + data_size, PROT_READ | PROT_WRITE, MAP_SHARED, ev->fd, 0);
+    if (map == MAP_FAILED) {
+        close(ev->fd);
+        ev->fd = -1;
+        return -1;
+    }
+    ev->page = (struct perf_event_mmap_page*)map;
+    ev->mapped_size = page + data_size;
+    ev->data = (const char*)map + page;
+    ev->data_mask = data_size - 1;
+    ev->tail = __atomic_load_n(&ev->page->data_head, __ATOMIC_ACQUIRE);
+    return 0;
+}
+
+static void event_close(FaultEvent* ev) {
+    if (ev->page) munmap(ev->page, ev->mapped_size);
+    if (ev->fd >= 0) close(ev->fd);
+}
+
+static uint64_t event_read(FaultEvent* ev) {
+    if (ev->page) {
+        uint64_t head = __atomic_load_n(&ev->page->data_head, __ATOMIC_ACQUIRE);
+        if (head == ev->tail) return ev->count;
+
+        // Записи выровнены на 8 байт, поэтому заголовок никогда не разрезан краем буфера
+        int resync = 0;
+        while (ev->tail < head) {
+            const struct perf_event_header* hdr =
+                (const struct perf_event_header*)(ev->data + (ev->tail & ev->data_mask));
+            if (hdr->size == 0) {
+                ev->tail = head;
+                resync = 1;
+                break;
+            }
+            if (hdr->type == PERF_RECORD_SAMPLE) {
+                ev->count++;
+            } else {
+                resync = 1; // PERF_RECORD_LOST или THROTTLE: часть отказов без записей
+            }
+            ev->tail += hdr->size;
+        }
+        __atomic_store_n(&ev->page->data_tail, ev->tail, __ATOMIC_RELEASE);
+        if (!resync) return ev->count;
+    }
+
+    uint64_t value;
+    if (read(ev->fd, &value, sizeof(value)) == (ssize_t)sizeof(value)) {
+        ev->count = value;
+    }
+    return ev->count;
+}
+
+FaultCounter* faultcount_create(FaultCountMethod method) {
+    FaultCounter* fc = (FaultCounter*)calloc(1, sizeof(FaultCounter));
+    if (!fc) return NULL;
+    fc->minor.fd = -1;
+    fc->major.fd = -1;
+
+    for (; method < FAULTCOUNT_RUSAGE; method++) {
+        if (event_open(&fc->minor, PERF_COUNT_SW_PAGE_FAULTS_MIN, method) == 0 &&
+            event_open(&fc->major, PERF_COUNT_SW_PAGE_FAULTS_MAJ, method) == 0) {
+            break;
+        }
+        event_close(&fc->minor);
+        event_close(&fc->major);
+        memset(&fc->minor, 0, sizeof(fc->minor));
+        memset(&fc->major, 0, sizeof(fc->major));
+        fc->minor.fd = -1;
+        fc->major.fd = -1;
+    }
+    fc->method = method;
+    return fc;
+}
+
+void faultcount_read(FaultCounter* fc, uint64_t* minor, uint64_t* major) {
+    if (fc->method == FAULTCOUNT_RUSAGE) {
+        struct rusage usage;
+        getrusage(RUSAGE_THREAD, &usage);
+        if (minor) *minor = (uint64_t)usage.ru_minflt;
+        if (major) *major = (uint64_t)usage.ru_majflt;
+        return;
+    }
+    uint64_t min = event_read(&fc->minor);
+    uint64_t maj = event_read(&fc->major);
+    if (minor) *minor = min;
+    if (major) *major = maj;
+}
+
+FaultCountMethod faultcount_method(const FaultCounter* fc) {
+    return fc->method;
+}
+
+const char* faultcount_method_name(FaultCountMethod method) {
+    switch (method) {
+    case FAULTCOUNT_RING: return "perf ring (mmap, no syscall)";
+    case FAULTCOUNT_READ: return "perf read()";
+    case FAULTCOUNT_RUSAGE: return "getrusage";
+    }
+    return "unknown";
+}
+
+void faultcount_destroy(FaultCounter* fc) {
+    if (!fc) return;
+    if (fc->method != FAULTCOUNT_RUSAGE) {
+        event_close(&fc->minor);
+        event_close(&fc->major);
+    }
+    free(fc);
+}
@@ -0,0 +1,76 @@
+#ifndef FAULTCOUNT_H
+#define FAULTCOUNT_H
+
+#include <stdint.h>
+
+/*
+ * Счетчик page faults текущего потока без системного вызова на чтение.
+ *
+ * Для minor и major faults открываются программные события perf
+ * (PERF_COUNT_SW_PAGE_FAULTS_MIN/MAJ) с периодом выборки 1: ядро пишет
+ * короткую запись в кольцевой буфер события на каждый отказ. Буфер и его
+ * служебная страница отображены в процесс, поэтому чтение счетчика — это
+ * загрузка data_head и подсчет новых записей, без входа в ядро. Поле
+ * offset служебной страницы для программных событий обновляется только при
+ * переключении контекста, поэтому считать по нему нельзя.
+ *
+ * Если ядро сбросило часть записей (переполнение буфера, ограничение частоты
+ * выборки), значение один раз уточняется через read() дескриптора события.
+ * Если отобразить буфер не удалось, каждое чтение идет через read(); если
+ * perf_event_open недоступен (kernel.perf_event_paranoid, seccomp) —
+ * через getrusage(RUSAGE_THREAD).
+ *
+ * Считаются только отказы, случившиеся в пользовательском режиме: отказы
+ * ядра при копировании в пользовательский буфер (read(), MAP_POPULATE)
+ * не учитываются.
+ */
+
+/** Способ чтения счетчиков. */
+typedef enum {
+    FAULTCOUNT_RING,   ///< Кольцевой буфер perf, отображенный в процесс
+    FAULTCOUNT_READ,   ///< read() дескриптора события perf
+    FAULTCOUNT_RUSAGE  ///< getrusage(RUSAGE_THREAD)
+} FaultCountMethod;
+
+typedef struct FaultCounter FaultCounter;
+
+/**
+ * @brief Открывает счетчики minor и major faults вызывающего потока.
+ *
+ * @param method Наиболее быстрый допустимый способ чтения. Если он
+ *               недоступен, выбирается следующий по списку FaultCountMethod.
+ * @return Указатель на счетчик или NULL в случае ошибки.
+ */
+FaultCounter* faultcount_create(FaultCountMethod method);
+
+/**
+ * @brief Читает накопленное число отказов.
+ *
+ * Вызывается только из потока, создавшего счетчик.
+ *
+ * @param fc Указатель на счетчик.
+ * @param minor Число minor faults с момента создания (может быть NULL).
+ * @param major Число major faults с момента создания (может быть NULL).
+ */
+void faultcount_read(FaultCounter* fc, uint64_t* minor, uint64_t* major);
+
+/**
+ * @brief Возвращает способ чтения, выбранный фактически.
+ *
+ * @param fc Указатель на счетчик.
+ */
+FaultCountMethod faultcount_method(const FaultCounter* fc);
+
+/**
+ * @brief Возвращает имя способа чтения для вывода.
+ */
+const char* faultcount_method_name(FaultCountMethod method);
+
+/**
+ * @brief Закрывает события perf и освобождает счетчик.
+ *
+ * @param fc Указатель на счетчик (NULL игнорируется).
+ */
+void faultcount_destroy(FaultCounter* fc);
+
+#endif // FAULTCOUNT_H
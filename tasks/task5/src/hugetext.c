@@ -0,0 +1,132 @@
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include "hugetext.h"
+#include <limits.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#define HUGE_PAGE_SIZE (2UL * 1024 * 1024)
+
+// Исполняемое отображение файла программы из /proc/self/maps
+static int find_text(uintptr_t* start, uintptr_t* end) {
+    char exe[PATH_MAX];
+    ssize_t len = readlink("/proc/self/exe", exe, sizeof(exe) - 1);
+    if (len <= 0) return -1;
+    exe[len] = '\0';
+
+    FILE* f = fopen("/proc/self/maps", "r");
+    if (!f) return -1;
+    char line[PATH_MAX + 128];
+    int found = -1;
+    while (fgets(line, sizeof(line), f)) {
+        unsigned long s, e;
+        char perms[5];
+        char path[PATH_MAX];
+        if (sscanf(line, "%lx-%lx %4s %*s %*s %*s %4095s", &s, &e, perms, path) != 4) continue;
+        if (perms[2] == 'x' && strcmp(path, exe) == 0) {
+            *start = s;
+            *end = e;
+            found = 0;
+            break;
+        }
+    }
+    fclose(f);
+    return found;
+}
+
+// Размер huge pages в отображении, начинающемся с start (AnonHugePages или Private_Hugetlb)
+static size_t huge_bytes_at(uintptr_t start) {
+    FILE* f = fopen("/proc/self/smaps", "r");
+    if (!f) return 0;
+    char line[512];
+    int inside = 0;
+    size_t kb = 0;
+    while (fgets(line, sizeof(line), f)) {
+        unsigned long s, e;
+        if (sscanf(line, "%lx-%lx ", &s, &e) == 2) {
+            if (inside) break;
+            inside = (s == start);
+            continue;
+        }
+        if (!inside) continue;
+        unsigned long value;
+        if (sscanf(line, "AnonHugePages: %lu kB", &value) == 1 ||
+            sscanf(line, "Private_Hugetlb: %lu kB", &value) == 1) {
+            kb += value;
+        }
+    }
+    fclose(f);
+    return kb * 1024;
+}
+
+// Анонимная область на huge pages, выровненная по 2 МБ
+static void* map_huge(size_t len, int hugetlb, HugeTextBacking* backing) {
+    if (hugetlb) {
+        void* p = mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (p != MAP_FAILED) {
+            *backing = HUGETEXT_HUGETLB;
+            return p;
+        }
+    }
+
+    // PROT_NONE до madvise: при mlockall(MCL_FUTURE) область иначе заполнилась бы
+    // 4K страницами еще в mmap, а так заполняется в mprotect уже с MADV_HUGEPAGE
+    char* raw = mmap(NULL, len + HUGE_PAGE_SIZE, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (raw == MAP_FAILED) return NULL;
+    char* aligned = (char*)(((uintptr_t)raw + HUGE_PAGE_SIZE - 1) & ~(uintptr_t)(HUGE_PAGE_SIZE - 1));
+    if (aligned > raw) munmap(raw, (size_t)(aligned - raw));
+    size_t tail = (size_t)(raw + len + HUGE_PAGE_SIZE - (aligned + len));
+    if (tail) munmap(aligned + len, tail);
+    madvise(aligned, len, MADV_HUGEPAGE);
+    if (mprotect(aligned, len, PROT_READ | PROT_WRITE) != 0) {
+        munmap(aligned, len);
+        return NULL;
+    }
+    *backing = HUGETEXT_THP;
+    return aligned;
+}
+
+int hugetext_remap(HugeTextInfo* info) {
+    HugeTextInfo r;
+    memset(&r, 0, sizeof(r));
+    if (find_text(&r.text_start, &r.text_end) != 0) return -1;
+
+    r.remap_start = (r.text_start + HUGE_PAGE_SIZE - 1) & ~(uintptr_t)(HUGE_PAGE_SIZE - 1);
+    r.remap_end = r.text_end & ~(uintptr_t)(HUGE_PAGE_SIZE - 1);
+    if (r.remap_start >= r.remap_end) {
+        r.remap_start = r.remap_end = 0;
+        if (info) *info = r;
+        return 0;
+    }
+    size_t len = r.remap_end - r.remap_start;
+
+    // Копия кода на huge pages; mremap ставит ее на место оригинала атомарно,
+    // и выполняющийся сейчас код продолжает работу по тем же адресам.
+    // Если ядро не умеет mremap для hugetlb, вторая попытка — на THP
+    for (int hugetlb = 1; hugetlb >= 0; --hugetlb) {
+        void* copy = map_huge(len, hugetlb, &r.backing);
+        if (!copy) return -1;
+        memcpy(copy, (const void*)r.remap_start, len);
+        if (mprotect(copy, len, PROT_READ | PROT_EXEC) == 0 &&
+            mremap(copy, len, len, MREMAP_MAYMOVE | MREMAP_FIXED, (void*)r.remap_start) != MAP_FAILED) {
+            r.huge_bytes = huge_bytes_at(r.remap_start);
+            if (info) *info = r;
+            return 0;
+        }
+        munmap(copy, len);
+        if (r.backing != HUGETEXT_HUGETLB) break;
+    }
+    return -1;
+}
+
+const char* hugetext_backing_name(HugeTextBacking backing) {
+    switch (backing) {
+    case HUGETEXT_NONE: return "none";
+    case HUGETEXT_HUGETLB: return "MAP_HUGETLB";
+    case HUGETEXT_THP: return "THP";
+    }
+    return "unknown";
+}
@@ -0,0 +1,55 @@
+#ifndef HUGETEXT_H
+#define HUGETEXT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Перенос кода программы на huge pages.
+ *
+ * Сегмент кода (.text) отображается из файла на 4K страницы, и в больших
+ * циклах промахи iTLB заметны в хвосте задержек. hugetext_remap() находит
+ * исполняемое отображение программы в /proc/self/maps, копирует его часть,
+ * выровненную по 2 МБ, в анонимную область на huge pages (MAP_HUGETLB, при
+ * нехватке — THP через madvise(MADV_HUGEPAGE)) и ставит копию на прежние
+ * адреса одним вызовом mremap(MREMAP_FIXED). Код продолжает выполняться
+ * по тем же адресам, поэтому функцию можно вызвать из любого места
+ * программы, в том числе из кода, который переносится.
+ *
+ * Вызывается один раз при старте, до создания потоков. Код короче 2 МБ
+ * или не содержащий целой выровненной huge page не переносится. После
+ * переноса в /proc/self/maps у этого диапазона нет имени файла, поэтому
+ * perf не найдет в нем символы без карты (perf-<pid>.map).
+ */
+
+/** Чем обеспечен перенесенный код. */
+typedef enum {
+    HUGETEXT_NONE,    ///< Ничего не перенесено (код меньше выровненной huge page)
+    HUGETEXT_HUGETLB, ///< Явные huge pages (MAP_HUGETLB)
+    HUGETEXT_THP      ///< Transparent huge pages
+} HugeTextBacking;
+
+/** Результат переноса. */
+typedef struct {
+    uintptr_t text_start;   ///< Исполняемое отображение программы
+    uintptr_t text_end;
+    uintptr_t remap_start;  ///< Перенесенная часть, выровненная по 2 МБ
+    uintptr_t remap_end;
+    HugeTextBacking backing;
+    size_t huge_bytes;      ///< Сколько из нее фактически на huge pages (по smaps)
+} HugeTextInfo;
+
+/**
+ * @brief Переносит код программы на huge pages.
+ *
+ * @param info Результат переноса (может быть NULL).
+ * @return 0 в случае успеха (в том числе если переносить нечего), -1 в случае ошибки.
+ */
+int hugetext_remap(HugeTextInfo* info);
+
+/**
+ * @brief Возвращает имя способа для вывода.
+ */
+const char* hugetext_backing_name(HugeTextBacking backing);
+
+#endif // HUGETEXT_H
@@ -0,0 +1,105 @@
+#ifndef LFSTACK_H
+#define LFSTACK_H
+
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Lock-free стек элементов, адресуемых номером idx (1..N, 0 — пустой стек).
+ *
+ * По номеру элемента владелец стека находит его ссылку — 4 байта внутри
+ * элемента, где хранится номер следующего элемента (функция LfLocate).
+ * Голова — 64-битное слово: младшие 32 бита — номер верхнего элемента,
+ * старшие 32 бита — тег версии, который меняется при каждой замене головы
+ * и защищает CAS от проблемы ABA.
+ */
+
+typedef _Atomic uint64_t LfHead;
+
+/** Возвращает ссылку элемента idx. Вызывается из inline-функций и встраивается. */
+typedef _Atomic uint32_t* (*LfLocate)(const void* owner, uint32_t idx);
+
+static inline uint64_t lfstack_tagged(uint64_t old_head, uint32_t idx) {
+    return (((old_head >> 32) + 1) << 32) | idx;
+}
+
+/** Снимает верхний элемент; возвращает его номер или 0, если стек пуст. */
+static inline uint32_t lfstack_pop(LfHead* head, LfLocate locate, const void* owner) {
+    uint64_t old_head = atomic_load_explicit(head, memory_order_acquire);
+    for (;;) {
+        uint32_t idx = (uint32_t)old_head;
+        if (idx == 0) {
+            return 0;
+        }
+        // Элемент мог быть уже снят другим потоком и перезаписан: тогда
+        // прочитанная ссылка — мусор, но тег головы изменился и CAS не пройдет
+        uint32_t next = atomic_load_explicit(locate(owner, idx), memory_order_relaxed);
+        if (atomic_compare_exchange_weak_explicit(head, &old_head,
+                                                  lfstack_tagged(old_head, next),
+                                                  memory_order_acquire,
+                                                  memory_order_acquire)) {
+            return idx;
+        }
+    }
+}
+
+/**
+ * Снимает до n верхних элементов одним CAS и возвращает номер первого из них
+ * (0, если стек пуст); количество снятых пишется в *count. Снятые элементы
+ * остаются связаны своими ссылками в прежнем порядке.
+ *
+ * Пока CAS не прошел, ссылки могут читаться из уже снятых и перезаписанных
+ * элементов. Номер больше *limit обрывает обход до обращения по нему, а
+ * неактуальную цепочку отбрасывает CAS: тег головы в этом случае изменился.
+ * Граница перечитывается после каждого чтения головы: растущий стек
+ * увеличивает ее до того, как кладет новые элементы, и элемент, уже
+ * видимый в голове, всегда оказывается в пределах границы.
+ */
+static inline uint32_t lfstack_pop_n(LfHead* head, LfLocate locate, const void* owner,
+                                     size_t n, const _Atomic size_t* limit_src, size_t* count) {
+    uint64_t old_head = atomic_load_explicit(head, memory_order_acquire);
+    for (;;) {
+        uint32_t limit = (uint32_t)atomic_load_explicit(limit_src, memory_order_acquire);
+        uint32_t first = (uint32_t)old_head;
+        uint32_t idx = first;
+        size_t taken = 0;
+        while (taken < n && idx != 0 && idx <= limit) {
+            idx = atomic_load_explicit(locate(owner, idx), memory_order_relaxed);
+            taken++;
+        }
+        if (taken == 0) {
+            *count = 0;
+            return 0;
+        }
+        if (atomic_compare_exchange_weak_explicit(head, &old_head,
+                                                  lfstack_tagged(old_head, idx),
+                                                  memory_order_acquire,
+                                                  memory_order_acquire)) {
+            *count = taken;
+            return first;
+        }
+    }
+}
+
+/**
+ * Кладет на вершину стека готовую цепочку first -> ... -> last одним CAS.
+ * Ссылки внутри цепочки должны быть проставлены заранее, last_link — ссылка
+ * последнего элемента.
+ */
+static inline void lfstack_push_chain(LfHead* head, _Atomic uint32_t* last_link, uint32_t first) {
+    uint64_t old_head = atomic_load_explicit(head, memory_order_relaxed);
+    do {
+        atomic_store_explicit(last_link, (uint32_t)old_head, memory_order_relaxed);
+    } while (!atomic_compare_exchange_weak_explicit(head, &old_head,
+                                                    lfstack_tagged(old_head, first),
+                                                    memory_order_release,
+                                                    memory_order_relaxed));
+}
+
+/** Кладет элемент idx (со ссылкой link) на вершину стека. */
+static inline void lfstack_push(LfHead* head, _Atomic uint32_t* link, uint32_t idx) {
+    lfstack_push_chain(head, link, idx);
+}
+
+#endif // LFSTACK_H
@@ -0,0 +1,202 @@
+#include "magazine.h"
+#include "lfstack.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+
+#define CACHE_LINE_SIZE 64
+
+// Магазин: стек блоков фиксированной емкости
+typedef struct Magazine {
+    _Atomic uint32_t next; // Ссылка в стеке депо (см. lfstack.h), должна быть первой
+    uint32_t self;         // Собственный номер магазина в массиве (1..N)
+    size_t count;          // Количество блоков в магазине
+    void* rounds[];
+} Magazine;
+
+struct MagazineCache {
+    MemoryPool* pool;
+    size_t rounds;
+    size_t stride;         // Размер магазина в массиве, кратный кэш-линии
+    size_t magazine_count;
+    char* magazines;
+
+    // Депо: стеки полных и пустых магазинов, каждый в своей кэш-линии
+    _Alignas(CACHE_LINE_SIZE) LfHead full;
+    _Alignas(CACHE_LINE_SIZE) LfHead empty;
+};
+
+struct MagazineThread {
+    MagazineCache* cache;
+    Magazine* loaded;   // Магазин, с которым идет работа
+    Magazine* previous; // Запасной магазин: всегда либо полный, либо пустой
+};
+
+static inline Magazine* magazine_at(const MagazineCache* cache, uint32_t idx) {
+    return (Magazine*)(cache->magazines + (size_t)(idx - 1) * cache->stride);
+}
+
+static inline _Atomic uint32_t* magazine_link(const void* owner, uint32_t idx) {
+    return &magazine_at((MagazineCache*)owner, idx)->next;
+}
+
+static inline void depot_push(LfHead* head, Magazine* mag) {
+    lfstack_push(head, &mag->next, mag->self);
+}
+
+static inline Magazine* depot_pop(MagazineCache* cache, LfHead* head) {
+    uint32_t idx = lfstack_pop(head, magazine_link, cache);
+    return idx ? magazine_at(cache, idx) : NULL;
+}
+
+MagazineCache* magazine_cache_create(MemoryPool* pool, size_t rounds, size_t magazine_count) {
+    if (!pool || rounds == 0 || magazine_count == 0 || magazine_count >= UINT32_MAX) {
+        return NULL;
+    }
+
+    MagazineCache* cache = (MagazineCache*)aligned_alloc(CACHE_LINE_SIZE, sizeof(MagazineCache));
+    if (!cache) return NULL;
+
+    cache->pool = pool;
+    cache->rounds = rounds;
+    cache->stride = (sizeof(Magazine) + rounds * sizeof(void*) + CACHE_LINE_SIZE - 1)
+                    & ~(size_t)(CACHE_LINE_SIZE - 1);
+    cache->magazine_count = magazine_count;
+    cache->magazines = (char*)aligned_alloc(CACHE_LINE_SIZE, cache->stride * magazine_count);
+    if (!cache->magazines) {
+        free(cache);
+        return NULL;
+    }
+
+    // Магазины используются в RT-цикле, поэтому держим их в RAM
+    mlock(cache->magazines, cache->stride * magazine_count);
+
+    atomic_init(&cache->full, 0);
+    atomic_init(&cache->empty, 0);
+    for (size_t i = 0; i < magazine_count; ++i) {
+        Magazine* mag = (Magazine*)(cache->magazines + i * cache->stride);
+        mag->self = (uint32_t)(i + 1);
+        mag->count = 0;
+        depot_push(&cache->empty, mag);
+    }
+
+    return cache;
+}
+
+MagazineThread* magazine_thread_attach(MagazineCache* cache) {
+    if (!cache) return NULL;
+
+    MagazineThread* thread = (MagazineThread*)aligned_alloc(CACHE_LINE_SIZE, CACHE_LINE_SIZE);
+    if (!thread) return NULL;
+
+    thread->cache = cache;
+    thread->loaded = depot_pop(cache, &cache->empty);
+    thread->previous = depot_pop(cache, &cache->empty);
+    if (!thread->loaded || !thread->previous) {
+        magazine_thread_detach(thread);
+        return NULL;
+    }
+    return thread;
+}
+
+void* magazine_alloc(MagazineThread* thread) {
+    Magazine* loaded = thread->loaded;
+    if (loaded->count > 0) {
+        return loaded->rounds[--loaded->count];
+    }
+
+    // Запасной магазин полон — поменять местами
+    MagazineCache* cache = thread->cache;
+    Magazine* previous = thread->previous;
+    if (previous->count > 0) {
+        thread->loaded = previous;
+        thread->previous = loaded;
+        return previous->rounds[--previous->count];
+    }
+
+    // Оба пусты: отдать пустой магазин в депо и взять оттуда полный
+    Magazine* full = depot_pop(cache, &cache->full);
+    if (full) {
+        depot_push(&cache->empty, previous);
+        thread->previous = loaded;
+        thread->loaded = full;
+        return full->rounds[--full->count];
+    }
+
+    // В депо нет полных магазинов: дозаполнить текущий из центрального пула
+    while (loaded->count < cache->rounds) {
+        void* block = pool_alloc_mt(cache->pool);
+        if (!block) break;
+        loaded->rounds[loaded->count++] = block;
+    }
+    return loaded->count > 0 ? loaded->rounds[--loaded->count] : NULL;
+}
+
+void magazine_free(MagazineThread* thread, void* block) {
+    if (!block) return;
+
+    MagazineCache* cache = thread->cache;
+    Magazine* loaded = thread->loaded;
+    if (loaded->count < cache->rounds) {
+        loaded->rounds[loaded->count++] = block;
+        return;
+    }
+
+    // Запасной магазин пуст — поменять местами
+    Magazine* previous = thread->previous;
+    if (previous->count == 0) {
+        thread->loaded = previous;
+        thread->previous = loaded;
+        previous->rounds[previous->count++] = block;
+        return;
+    }
+
+    // Оба полны: отдать полный магазин в депо и взять оттуда пустой
+    Magazine* empty = depot_pop(cache, &cache->empty);
+    if (empty) {
+        depot_push(&cache->full, previous);
+        thread->previous = loaded;
+        thread->loaded = empty;
+        empty->rounds[empty->count++] = block;
+        return;
+    }
+
+    // Пустых магазинов не осталось: вернуть блок прямо в центральный пул
+    pool_free_mt(cache->pool, block);
+}
+
+// Отдает магазин в депо; частично заполненный сначала опустошается в пул
+static void magazine_release(MagazineCache* cache, Magazine* mag) {
+    if (!mag) return;
+
+    if (mag->count == cache->rounds) {
+        depot_push(&cache->full, mag);
+        return;
+    }
+    while (mag->count > 0) {
+        pool_free_mt(cache->pool, mag->rounds[--mag->count]);
+    }
+    depot_push(&cache->empty, mag);
+}
+
+void magazine_thread_detach(MagazineThread* thread) {
+    if (!thread) return;
+
+    magazine_release(thread->cache, thread->loaded);
+    magazine_release(thread->cache, thread->previous);
+    free(thread);
+}
+
+void magazine_cache_destroy(MagazineCache* cache) {
+    if (!cache) return;
+
+    Magazine* mag;
+    while ((mag = depot_pop(cache, &cache->full)) != NULL) {
+        while (mag->count > 0) {
+            pool_free_mt(cache->pool, mag->rounds[--mag->count]);
+        }
+    }
+    munlock(cache->magazines, cache->stride * cache->magazine_count);
+    free(cache->magazines);
+    free(cache);
+}
@@ -0,0 +1,73 @@
+#ifndef MAGAZINE_H
+#define MAGAZINE_H
+
+#include <stddef.h>
+#include "mempool.h"
+
+/*
+ * Слой "магазинов" (per-thread кэш) поверх потокобезопасного MemoryPool.
+ *
+ * Каждый поток держит два магазина — небольших локальных стека блоков
+ * (loaded и previous). pool_alloc/pool_free в большинстве случаев работают
+ * только с ними и не трогают общую память. Когда оба магазина пусты (или
+ * оба полны), поток одним CAS обменивает магазин целиком с общим депо,
+ * а если в депо нет подходящего магазина — обращается к центральному пулу.
+ */
+
+typedef struct MagazineCache MagazineCache;
+typedef struct MagazineThread MagazineThread;
+
+/**
+ * @brief Создает кэш магазинов над пулом.
+ *
+ * @param pool Центральный пул, созданный с флагом POOL_CONCURRENT.
+ * @param rounds Емкость одного магазина (количество блоков).
+ * @param magazine_count Общее количество магазинов (не меньше 2 на поток).
+ * @return Указатель на кэш или NULL в случае ошибки.
+ */
+MagazineCache* magazine_cache_create(MemoryPool* pool, size_t rounds, size_t magazine_count);
+
+/**
+ * @brief Подключает текущий поток к кэшу (вызывать вне RT-цикла).
+ *
+ * @param cache Указатель на кэш.
+ * @return Дескриптор потока или NULL, если в депо не хватило пустых магазинов.
+ */
+MagazineThread* magazine_thread_attach(MagazineCache* cache);
+
+/**
+ * @brief Выделяет блок через магазины потока.
+ *
+ * Худший случай ограничен: обмен магазина с депо (два CAS) либо дозаполнение
+ * магазина из центрального пула (не более rounds вызовов pool_alloc_mt).
+ *
+ * @param thread Дескриптор потока.
+ * @return Указатель на блок или NULL, если пул исчерпан.
+ */
+void* magazine_alloc(MagazineThread* thread);
+
+/**
+ * @brief Возвращает блок в магазины потока.
+ *
+ * @param thread Дескриптор потока.
+ * @param block Указатель на блок.
+ */
+void magazine_free(MagazineThread* thread, void* block);
+
+/**
+ * @brief Возвращает магазины потока в депо и освобождает дескриптор.
+ *
+ * @param thread Дескриптор потока.
+ */
+void magazine_thread_detach(MagazineThread* thread);
+
+/**
+ * @brief Уничтожает кэш. Все потоки должны быть отключены заранее.
+ *
+ * Блоки, лежащие в магазинах депо, возвращаются в центральный пул.
+ *
+ * @param cache Указатель на кэш.
+ */
+void magazine_cache_destroy(MagazineCache* cache);
+
+#endif // MAGAZINE_H
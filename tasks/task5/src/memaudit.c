@@ -0,0 +1,165 @@
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include "memaudit.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#ifndef MADV_POPULATE_READ
+#define MADV_POPULATE_READ 22
+#endif
+#ifndef MADV_POPULATE_WRITE
+#define MADV_POPULATE_WRITE 23
+#endif
+
+#define VEC_PAGES 4096 // Страниц на один вызов mincore
+
+// Отображение из /proc/self/smaps
+typedef struct {
+    uintptr_t start;
+    uintptr_t end;
+    char perms[5];
+    int locked;  // VmFlags: lo
+    int special; // VmFlags: io или pf — mincore неприменим
+    char name[64];
+} Mapping;
+
+// Список отображений читается целиком до проверки: mlock и выделения памяти
+// во время проверки не должны менять файл, который еще читается
+static Mapping* read_mappings(size_t* count) {
+    FILE* f = fopen("/proc/self/smaps", "r");
+    if (!f) return NULL;
+
+    size_t capacity = 64;
+    size_t n = 0;
+    Mapping* maps = (Mapping*)malloc(capacity * sizeof(Mapping));
+    char line[512];
+    while (maps && fgets(line, sizeof(line), f)) {
+        unsigned long start, end;
+        char perms[5];
+        if (sscanf(line, "%lx-%lx %4s", &start, &end, perms) == 3) {
+            if (n == capacity) {
+                capacity *= 2;
+                Mapping* grown = (Mapping*)realloc(maps, capacity * sizeof(Mapping));
+                if (!grown) {
+                    free(maps);
+                    maps = NULL;
+                    break;
+                }
+                maps = grown;
+            }
+            Mapping* m = &maps[n++];
+            memset(m, 0, sizeof(*m));
+            m->start = start;
+            m->end = end;
+            memcpy(m->perms, perms, sizeof(m->perms));
+            if (sscanf(line, "%*s %*s %*s %*s %*s %63[^\n]", m->name) != 1) m->name[0] = '\0';
+        } else if (n > 0 && strncmp(line, "VmFlags:", 8) == 0) {
+            Mapping* m = &maps[n - 1];
+            for (char* tok = strtok(line + 8, " \n"); tok; tok = strtok(NULL, " \n")) {
+                if (strcmp(tok, "lo") == 0) m->locked = 1;
+                if (strcmp(tok, "io") == 0 || strcmp(tok, "pf") == 0) m->special = 1;
+            }
+        }
+    }
+    fclose(f);
+    *count = n;
+    return maps;
+}
+
+// Заблокировать участок; если нельзя — хотя бы заполнить. 1 — заблокирован
+static int fix_range(uintptr_t start, size_t size, const char* perms, MemAuditReport* r) {
+    if (mlock((void*)start, size) == 0) {
+        r->fixed_bytes += size;
+        return 1;
+    }
+    int advice = perms[1] == 'w' ? MADV_POPULATE_WRITE : MADV_POPULATE_READ;
+    if (madvise((void*)start, size, advice) == 0) r->fixed_bytes += size;
+    return 0;
+}
+
+// Отображение из образа программы или библиотеки: у того же файла есть исполняемое
+// отображение. Такой код и его данные (GOT, .data) RT-цикл касается при каждом вызове
+static int image_mapping(const Mapping* maps, size_t count, const Mapping* m) {
+    if (m->name[0] != '/') return 0;
+    for (size_t i = 0; i < count; ++i) {
+        if (maps[i].perms[2] == 'x' && strcmp(maps[i].name, m->name) == 0) return 1;
+    }
+    return 0;
+}
+
+int memaudit_run(unsigned flags, FILE* out, MemAuditReport* report) {
+    static unsigned char vec[VEC_PAGES];
+    MemAuditReport r;
+    memset(&r, 0, sizeof(r));
+
+    size_t count;
+    Mapping* maps = read_mappings(&count);
+    if (!maps) return -1;
+
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    int clean = 1;
+    for (size_t i = 0; i < count; ++i) {
+        Mapping* m = &maps[i];
+        // Страницы vDSO ядро держит в RAM само, заблокировать их нельзя
+        if (m->special || strcmp(m->name, "[vsyscall]") == 0 || strcmp(m->name, "[vdso]") == 0) continue;
+        if (strncmp(m->perms, "---", 3) == 0) continue;
+        if ((flags & MEMAUDIT_LOCKED_ONLY) && !m->locked && !image_mapping(maps, count, m)) continue;
+
+        size_t size = m->end - m->start;
+        r.mappings++;
+        r.total_bytes += size;
+
+        // Непрерывные участки нерезидентных страниц
+        size_t missing = 0, runs = 0;
+        uintptr_t first_missing = 0;
+        int in_run = 0;
+        for (uintptr_t addr = m->start; addr < m->end; addr += VEC_PAGES * page) {
+            size_t len = m->end - addr < VEC_PAGES * page ? m->end - addr : VEC_PAGES * page;
+            if (mincore((void*)addr, len, vec) != 0) break;
+            for (size_t p = 0; p < len / page; ++p) {
+                if (vec[p] & 1) {
+                    in_run = 0;
+                    continue;
+                }
+                if (!first_missing) first_missing = addr + p * page;
+                if (!in_run) runs++;
+                in_run = 1;
+                missing += page;
+            }
+        }
+        r.nonresident_bytes += missing;
+        if (!m->locked) r.unlocked_bytes += size;
+        if (m->locked && missing == 0) continue;
+
+        // mlock всего отображения и блокирует, и заполняет нерезидентные участки
+        int fixed = (flags & MEMAUDIT_FIX) ? fix_range(m->start, size, m->perms, &r) : 0;
+        if (!fixed) clean = 0;
+
+        if (out && !(flags & MEMAUDIT_QUIET)) {
+            fprintf(out, "memaudit: %012lx-%012lx %s %-24s %8zu KB", (unsigned long)m->start,
+                    (unsigned long)m->end, m->perms, m->name[0] ? m->name : "[anon]", size / 1024);
+            if (missing) {
+                fprintf(out, ", %zu KB not resident in %zu runs from %lx", missing / 1024, runs,
+                        (unsigned long)first_missing);
+            }
+            if (!m->locked) fprintf(out, ", unlocked");
+            if (flags & MEMAUDIT_FIX) fprintf(out, fixed ? " -> locked" : " -> not fixed");
+            fprintf(out, "\n");
+        }
+    }
+    free(maps);
+
+    if (out) {
+        fprintf(out, "memaudit: %zu mappings, %.1f MB: %zu KB not resident, %zu KB unlocked",
+                r.mappings, r.total_bytes / (1024.0 * 1024.0), r.nonresident_bytes / 1024,
+                r.unlocked_bytes / 1024);
+        if (flags & MEMAUDIT_FIX) fprintf(out, ", %zu KB fixed", r.fixed_bytes / 1024);
+        fprintf(out, ": %s\n", clean ? "OK" : "NOT READY");
+    }
+    if (report) *report = r;
+    return clean ? 0 : 1;
+}
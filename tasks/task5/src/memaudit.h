@@ -0,0 +1,64 @@
+#ifndef MEMAUDIT_H
+#define MEMAUDIT_H
+
+#include <stddef.h>
+#include <stdio.h>
+
+/*
+ * Проверка резидентности памяти перед входом в RT-цикл.
+ *
+ * memaudit_run() читает /proc/self/smaps и для каждого отображения проверяет
+ * две вещи: заблокировано ли оно (флаг lo в VmFlags) и все ли его страницы
+ * в RAM (mincore). Найденные участки печатаются, а с MEMAUDIT_FIX еще и
+ * исправляются: mlock() заполняет и блокирует их. Если блокировка запрещена,
+ * страницы хотя бы заполняются через MADV_POPULATE_READ/WRITE.
+ *
+ * Для файловых отображений mincore сообщает о наличии страницы в page cache,
+ * а не в таблице страниц процесса. У заблокированных отображений эти
+ * понятия совпадают, поэтому проверка точна для всего, что должно быть
+ * заблокировано.
+ *
+ * Отображения без прав доступа (guard-страницы, зарезервированные
+ * диапазоны), а также [vvar], [vdso] и [vsyscall] пропускаются.
+ */
+
+/**
+ * @brief Флаги memaudit_run().
+ */
+enum {
+    /** Заполнить и заблокировать найденные участки. */
+    MEMAUDIT_FIX = 1u << 0,
+    /** Проверять только заблокированные отображения и образы программы
+     *  и библиотек (код и их данные): режим выборочной блокировки
+     *  (RTMEM_SELECTIVE), где остальную память RT-путь не трогает. */
+    MEMAUDIT_LOCKED_ONLY = 1u << 1,
+    /** Печатать только итоговую строку, без списка участков. */
+    MEMAUDIT_QUIET = 1u << 2,
+};
+
+/**
+ * @brief Итоги проверки.
+ */
+typedef struct {
+    size_t mappings;          ///< Проверено отображений.
+    size_t total_bytes;       ///< Их суммарный размер.
+    size_t nonresident_bytes; ///< Страниц не в RAM.
+    size_t unlocked_bytes;    ///< Размер незаблокированных отображений.
+    size_t fixed_bytes;       ///< Заблокировано или заполнено с MEMAUDIT_FIX.
+} MemAuditReport;
+
+/**
+ * @brief Проверяет все отображения процесса.
+ *
+ * Вызывается вне RT-цикла: читает /proc, выделяет память и делает системные
+ * вызовы на каждое отображение.
+ *
+ * @param flags Комбинация флагов MEMAUDIT_*.
+ * @param out Куда печатать участки и итог (NULL — ничего не печатать).
+ * @param report Итоги проверки (может быть NULL).
+ * @return 0, если нерезидентных и незаблокированных участков нет (или все
+ *         исправлены), 1, если они остались, -1 в случае ошибки.
+ */
+int memaudit_run(unsigned flags, FILE* out, MemAuditReport* report);
+
+#endif // MEMAUDIT_H
@@ -1,62 +1,588 @@
+#define _GNU_SOURCE
 #include "mempool.h"
+#include "lfstack.h"
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
 #include <sys/mman.h>
 
+#define CACHE_LINE_SIZE 64
+#define DEFAULT_HUGE_PAGE_SIZE (2UL * 1024 * 1024)
+#define DEFAULT_GROW_FACTOR 16
+#define DEFAULT_GROW_PERIOD_US 1000
+
 // Узел в связном списке свободных блоков
 typedef struct Node {
     struct Node* next;
 } Node;
 
 // Структура, описывающая пул
+#ifdef POOL_STATS
+// Счетчики вызовов для выборки замеров: у каждого пула свои, по слоту на поток
+// (потоки распределяются по слотам по кругу), каждый слот в своей кэш-линии
+#define STATS_TICK_SLOTS 16
+
+typedef struct {
+    _Alignas(CACHE_LINE_SIZE) _Atomic unsigned value;
+} StatsTick;
+#endif
+
 struct MemoryPool {
-    size_t block_size;
+    size_t block_size;     // Шаг между блоками (с учетом выравнивания)
+    size_t block_count;
     Node* free_list_head; 
+    size_t bump_idx;       // Ленивый режим: номер следующего еще не выданного блока
+    size_t bump_end;
     void* memory_start;    
+
+    // Раскраска: область делится на слэбы по slab_blocks блоков, слэб k
+    // сдвинут на (k % color_count) * color_step байт. slab_blocks == 0 — без раскраски
+    size_t slab_blocks;
+    size_t slab_span;
+    size_t color_step;
+    size_t color_count;
+
     size_t memory_total_size;
+    size_t memory_mapped_size; // Размер mmap-области (для POOL_HUGEPAGES)
+    PoolBacking backing;
+    unsigned flags;
+
+    // Голова lock-free списка (см. lfstack.h): номер блока + тег версии.
+    // Вынесена в отдельную кэш-линию, чтобы не делить ее с полями только для чтения.
+    _Alignas(CACHE_LINE_SIZE) LfHead mt_head;
+    _Atomic size_t mt_bump; // Номер следующего невыданного блока (POOL_CONCURRENT | POOL_LAZY)
+
+    // POOL_GROWABLE: фоновый поток дописывает новые блоки в зарезервированный диапазон
+    _Atomic size_t grow_in_use;        // Сколько блоков выдано сейчас
+    _Atomic(Node*) grow_incoming;      // Цепочка новых блоков для однопоточного режима
+    _Atomic size_t committed_blocks;   // Сколько блоков уже доступно (пишет только фоновый поток)
+    _Atomic int grow_stop;
+    size_t committed_bytes;            // Граница заблокированной части диапазона (кратна странице)
+    size_t max_block_count;
+    size_t grow_low_water;
+    size_t grow_chunk;
+    unsigned grow_period_us;
+    pthread_t grow_thread;
+
+    // pool_trim: страницы, отданные ОС, и свободные блоки, снятые со списка до pool_restore.
+    // Выделяются при первом вызове pool_trim
+    unsigned char* trim_pages;  // 1 — страница отдана ОС
+    unsigned char* trim_parked; // 1 — блок снят со списка
+    char* trim_base;            // Первая целая страница области
+    size_t trim_page_count;
+
+#ifdef POOL_STATS
+    // Статистика (см. pool_stats) — в своей кэш-линии, отдельно от mt_head
+    _Alignas(CACHE_LINE_SIZE) _Atomic size_t st_in_use;
+    _Atomic size_t st_peak;
+    _Atomic unsigned long long st_alloc;
+    _Atomic unsigned long long st_free;
+    _Atomic unsigned long long st_failed;
+    unsigned st_sample_period;
+    _Atomic unsigned long long st_samples;
+    _Atomic unsigned long long st_hist[POOL_STATS_BUCKETS];
+    StatsTick st_tick[STATS_TICK_SLOTS];
+#endif
 };
 
+// Смещение блока i от начала области
+static inline size_t block_offset(const MemoryPool* pool, size_t i) {
+    if (pool->slab_blocks == 0) {
+        return i * pool->block_size;
+    }
+    size_t slab = i / pool->slab_blocks;
+    return slab * pool->slab_span + (slab % pool->color_count) * pool->color_step +
+           (i - slab * pool->slab_blocks) * pool->block_size;
+}
+
+static inline char* block_at(const MemoryPool* pool, size_t i) {
+    return (char*)pool->memory_start + block_offset(pool, i);
+}
+
+// Номер блока по его адресу (обратное к block_offset)
+static inline size_t block_index(const MemoryPool* pool, const void* block) {
+    size_t offset = (size_t)((const char*)block - (const char*)pool->memory_start);
+    if (pool->slab_blocks == 0) {
+        return offset / pool->block_size;
+    }
+    size_t slab = offset / pool->slab_span;
+    size_t in_slab = offset - slab * pool->slab_span - (slab % pool->color_count) * pool->color_step;
+    return slab * pool->slab_blocks + in_slab / pool->block_size;
+}
+
+// Сколько байт области занимают блоки [0, count)
+static inline size_t layout_bytes(const MemoryPool* pool, size_t count) {
+    return count ? block_offset(pool, count - 1) + pool->block_size : 0;
+}
+
+// Ссылка блока idx (1..N) в lock-free списке — первые 4 байта блока
+static inline _Atomic uint32_t* pool_link(const void* owner, uint32_t idx) {
+    return (_Atomic uint32_t*)block_at((const MemoryPool*)owner, idx - 1);
+}
+
+// Размер huge page из /proc/meminfo (Hugepagesize), по умолчанию 2 МБ
+static size_t huge_page_size(void) {
+    size_t size = DEFAULT_HUGE_PAGE_SIZE;
+    FILE* f = fopen("/proc/meminfo", "r");
+    if (!f) return size;
+
+    char line[128];
+    unsigned long kb;
+    while (fgets(line, sizeof(line), f)) {
+        if (sscanf(line, "Hugepagesize: %lu kB", &kb) == 1) {
+            size = kb * 1024;
+            break;
+        }
+    }
+    fclose(f);
+    return size;
+}
+
+// Отображает область на huge pages, блокирует ее и прогревает
+static int region_map_huge(MemoryPool* pool) {
+    size_t huge = huge_page_size();
+    size_t length = (pool->memory_total_size + huge - 1) & ~(huge - 1);
+    size_t touch_step = huge;
+
+    // 1. Явные huge pages из пула ядра (vm.nr_hugepages)
+    char* region = mmap(NULL, length, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (region != MAP_FAILED) {
+        pool->backing = POOL_BACKING_HUGETLB;
+    } else {
+        // 2. THP: область выравнивается по границе huge page, чтобы ядро могло
+        //    отобразить ее целыми huge pages, лишние края отрезаются
+        char* raw = mmap(NULL, length + huge, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (raw == MAP_FAILED) {
+            return -1;
+        }
+        region = (char*)(((uintptr_t)raw + huge - 1) & ~(uintptr_t)(huge - 1));
+        if (region > raw) {
+            munmap(raw, (size_t)(region - raw));
+        }
+        munmap(region + length, (size_t)(raw + huge - region));
+        madvise(region, length, MADV_HUGEPAGE);
+        pool->backing = POOL_BACKING_THP;
+        // Если ядро не выдаст huge page, прогрев каждой 4K страницы все равно нужен
+        touch_step = (size_t)sysconf(_SC_PAGESIZE);
+    }
+
+    // Заблокировать и детерминированно прогреть всю область на этапе создания
+    mlock(region, length);
+    for (size_t off = 0; off < length; off += touch_step) {
+        ((volatile char*)region)[off] = 0;
+    }
+
+    pool->memory_start = region;
+    pool->memory_mapped_size = length;
+    return 0;
+}
+
+// Делает доступной, блокирует и прогревает часть резерва до границы end (байт от начала)
+static int region_commit(MemoryPool* pool, size_t end) {
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    end = (end + page - 1) & ~(page - 1);
+    if (end > pool->memory_mapped_size) {
+        end = pool->memory_mapped_size;
+    }
+    if (end <= pool->committed_bytes) {
+        return 0;
+    }
+
+    char* from = (char*)pool->memory_start + pool->committed_bytes;
+    size_t length = end - pool->committed_bytes;
+    if (mprotect(from, length, PROT_READ | PROT_WRITE) != 0) {
+        return -1;
+    }
+    if (!(pool->flags & POOL_LAZY) || mlock2(from, length, MLOCK_ONFAULT) != 0) {
+        // mlock сам отображает все страницы, дополнительный проход не нужен
+        mlock(from, length);
+    }
+    pool->committed_bytes = end;
+    return 0;
+}
+
+// Резервирует адресный диапазон под max_block_count блоков без выделения памяти
+static int region_reserve(MemoryPool* pool) {
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t length = (layout_bytes(pool, pool->max_block_count) + page - 1) & ~(page - 1);
+
+    void* region = mmap(NULL, length, PROT_NONE,
+                        MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (region == MAP_FAILED) {
+        return -1;
+    }
+    pool->memory_start = region;
+    pool->memory_mapped_size = length;
+    pool->committed_bytes = 0;
+    pool->backing = POOL_BACKING_RESERVE;
+
+    if (region_commit(pool, pool->memory_total_size) != 0) {
+        munmap(region, length);
+        return -1;
+    }
+    return 0;
+}
+
+// Один шаг роста: новые блоки связываются в цепочку и публикуются одной атомарной операцией
+static void pool_grow(MemoryPool* pool) {
+    size_t first = atomic_load_explicit(&pool->committed_blocks, memory_order_relaxed);
+    size_t count = pool->grow_chunk;
+    if (count > pool->max_block_count - first) {
+        count = pool->max_block_count - first;
+    }
+    if (count == 0 || region_commit(pool, layout_bytes(pool, first + count)) != 0) {
+        return;
+    }
+    // Граница поднимается до публикации: pool_alloc_mt_n, увидевший новый блок
+    // в голове стека, должен видеть и границу, в которую он входит
+    atomic_store_explicit(&pool->committed_blocks, first + count, memory_order_release);
+
+    if (pool->flags & POOL_CONCURRENT) {
+        for (size_t i = first; i + 1 < first + count; ++i) {
+            atomic_store_explicit(pool_link(pool, (uint32_t)(i + 1)), (uint32_t)(i + 2),
+                                  memory_order_relaxed);
+        }
+        lfstack_push_chain(&pool->mt_head, pool_link(pool, (uint32_t)(first + count)),
+                           (uint32_t)(first + 1));
+    } else {
+        for (size_t i = first; i + 1 < first + count; ++i) {
+            ((Node*)block_at(pool, i))->next = (Node*)block_at(pool, i + 1);
+        }
+        // Забирает цепочку только владелец пула (целиком, через exchange),
+        // поэтому единственному писателю ABA не грозит
+        Node* last = (Node*)block_at(pool, first + count - 1);
+        Node* old_head = atomic_load_explicit(&pool->grow_incoming, memory_order_relaxed);
+        do {
+            last->next = old_head;
+        } while (!atomic_compare_exchange_weak_explicit(&pool->grow_incoming, &old_head,
+                                                        (Node*)block_at(pool, first),
+                                                        memory_order_release,
+                                                        memory_order_relaxed));
+    }
+}
+
+// Фоновый поток роста: опрашивает число свободных блоков, RT-поток ему не сигналит
+static void* pool_grow_thread(void* arg) {
+    MemoryPool* pool = (MemoryPool*)arg;
+    struct timespec period = {
+        .tv_sec = pool->grow_period_us / 1000000,
+        .tv_nsec = (long)(pool->grow_period_us % 1000000) * 1000,
+    };
+
+    while (!atomic_load_explicit(&pool->grow_stop, memory_order_relaxed)) {
+        size_t committed = atomic_load_explicit(&pool->committed_blocks, memory_order_relaxed);
+        size_t in_use = atomic_load_explicit(&pool->grow_in_use, memory_order_relaxed);
+        if (committed < pool->max_block_count && committed - in_use < pool->grow_low_water) {
+            pool_grow(pool);
+            continue;
+        }
+        nanosleep(&period, NULL);
+    }
+    return NULL;
+}
+
 MemoryPool* pool_create(size_t block_size, size_t block_count) {
+    return pool_create_ex(block_size, block_count, NULL);
+}
+
+MemoryPool* pool_create_ex(size_t block_size, size_t block_count, const PoolOptions* opts) {
+    unsigned flags = opts ? opts->flags : 0;
+
     // Размер блока должен быть достаточным, чтобы вместить указатель Node
     if (block_size < sizeof(Node)) {
         block_size = sizeof(Node);
     }
+    // Выравнивание блоков: степень двойки не больше страницы (mmap-области выровнены только по ней)
+    size_t block_align = opts ? opts->block_align : 0;
+    if (block_align > 1) {
+        if ((block_align & (block_align - 1)) != 0 || block_align > (size_t)sysconf(_SC_PAGESIZE)) {
+            return NULL;
+        }
+        block_size = (block_size + block_align - 1) & ~(block_align - 1);
+    }
+    size_t max_block_count = block_count;
+    if (flags & POOL_GROWABLE) {
+        if (flags & POOL_HUGEPAGES) {
+            return NULL;
+        }
+        max_block_count = opts->max_block_count ? opts->max_block_count
+                                                : block_count * DEFAULT_GROW_FACTOR;
+        if (max_block_count < block_count) {
+            max_block_count = block_count;
+        }
+    }
+    // Номер блока в lock-free списке ограничен 32 битами
+    if ((flags & POOL_CONCURRENT) && max_block_count >= UINT32_MAX) {
+        return NULL;
+    }
 
-    // Выделить память для самой структуры пула
-    MemoryPool* pool = (MemoryPool*)malloc(sizeof(MemoryPool));
+    // Выделить память для самой структуры пула (с выравниванием под mt_head)
+    MemoryPool* pool = (MemoryPool*)aligned_alloc(CACHE_LINE_SIZE, sizeof(MemoryPool));
     if (!pool) return NULL;
 
     pool->block_size = block_size;
-    pool->memory_total_size = block_size * block_count;
-
-    // Выделить один большой кусок памяти для всех блоков
-    pool->memory_start = malloc(pool->memory_total_size);
-    if (!pool->memory_start) {
-        free(pool);
-        return NULL;
+    pool->block_count = block_count;
+    pool->slab_blocks = 0;
+    if (opts && opts->color_slab_size) {
+        // Сдвиг слэба кратен выравниванию блока, поэтому раскраска его не нарушает
+        size_t step = block_align > CACHE_LINE_SIZE ? block_align : CACHE_LINE_SIZE;
+        size_t span = opts->color_slab_size;
+        if (span < block_size + step) {
+            span = block_size + step;
+        }
+        span = (span + step - 1) & ~(step - 1);
+        pool->slab_blocks = (span - step) / block_size;
+        pool->slab_span = span;
+        pool->color_step = step;
+        pool->color_count = (span - pool->slab_blocks * block_size) / step;
     }
+    pool->memory_total_size = layout_bytes(pool, block_count);
+    pool->memory_mapped_size = 0;
+    pool->backing = POOL_BACKING_MALLOC;
+    pool->flags = flags;
+    pool->max_block_count = max_block_count;
+    atomic_init(&pool->grow_in_use, 0);
+    atomic_init(&pool->grow_incoming, NULL);
+    atomic_init(&pool->committed_blocks, block_count);
+    atomic_init(&pool->grow_stop, 0);
+    pool->trim_pages = NULL;
+    pool->trim_parked = NULL;
+#ifdef POOL_STATS
+    atomic_init(&pool->st_in_use, 0);
+    atomic_init(&pool->st_peak, 0);
+    atomic_init(&pool->st_alloc, 0);
+    atomic_init(&pool->st_free, 0);
+    atomic_init(&pool->st_failed, 0);
+    pool->st_sample_period = opts ? opts->stats_sample_period : 0;
+    atomic_init(&pool->st_samples, 0);
+    for (int i = 0; i < POOL_STATS_BUCKETS; i++) {
+        atomic_init(&pool->st_hist[i], 0);
+    }
+    for (int i = 0; i < STATS_TICK_SLOTS; i++) {
+        atomic_init(&pool->st_tick[i].value, 0);
+    }
+#endif
 
-    // Заблокировать выделенную память в RAM
-    mlock(pool->memory_start, pool->memory_total_size);
+    if (flags & POOL_GROWABLE) {
+        pool->grow_low_water = opts->grow_low_water ? opts->grow_low_water : block_count / 4;
+        pool->grow_chunk = opts->grow_chunk ? opts->grow_chunk : (block_count ? block_count : 1);
+        pool->grow_period_us = opts->grow_period_us ? opts->grow_period_us : DEFAULT_GROW_PERIOD_US;
+        if (region_reserve(pool) != 0) {
+            free(pool);
+            return NULL;
+        }
+    } else if (flags & POOL_HUGEPAGES) {
+        if (region_map_huge(pool) != 0) {
+            free(pool);
+            return NULL;
+        }
+    } else {
+        // Выделить один большой кусок памяти для всех блоков
+        size_t region_align = block_align;
+        if (pool->slab_blocks && region_align < CACHE_LINE_SIZE) {
+            region_align = CACHE_LINE_SIZE;
+        }
+        if (region_align > 1) {
+            size_t size = (pool->memory_total_size + region_align - 1) & ~(region_align - 1);
+            pool->memory_start = aligned_alloc(region_align, size ? size : region_align);
+        } else {
+            pool->memory_start = malloc(pool->memory_total_size);
+        }
+        if (!pool->memory_start) {
+            free(pool);
+            return NULL;
+        }
+
+        // Заблокировать выделенную память в RAM. В ленивом режиме страницы
+        // блокируются по мере первого касания, чтобы не раздувать RSS заранее
+        if (!(flags & POOL_LAZY) ||
+            mlock2(pool->memory_start, pool->memory_total_size, MLOCK_ONFAULT) != 0) {
+            mlock(pool->memory_start, pool->memory_total_size);
+        }
+    }
 
     // Разметить память как связный список свободных блоков
     pool->free_list_head = NULL;
-    for (size_t i = 0; i < block_count; ++i) {
-        Node* current_node = (Node*)((char*)pool->memory_start + i * block_size);
-        current_node->next = pool->free_list_head;
-        pool->free_list_head = current_node;
+    pool->bump_idx = pool->bump_end = 0;
+    atomic_init(&pool->mt_head, 0);
+    atomic_init(&pool->mt_bump, block_count);
+    if (flags & POOL_LAZY) {
+        // Список пуст, все блоки выдаются бегунком: создание пула — O(1)
+        pool->bump_end = block_count;
+        atomic_store_explicit(&pool->mt_bump, 0, memory_order_release);
+    } else if (flags & POOL_CONCURRENT) {
+        uint32_t head = 0;
+        for (size_t i = 0; i < block_count; ++i) {
+            uint32_t idx = (uint32_t)(i + 1);
+            atomic_init(pool_link(pool, idx), head);
+            head = idx;
+        }
+        atomic_store_explicit(&pool->mt_head, head, memory_order_release);
+    } else {
+        for (size_t i = 0; i < block_count; ++i) {
+            Node* current_node = (Node*)block_at(pool, i);
+            current_node->next = pool->free_list_head;
+            pool->free_list_head = current_node;
+        }
+    }
+
+    if ((flags & POOL_GROWABLE) &&
+        pthread_create(&pool->grow_thread, NULL, pool_grow_thread, pool) != 0) {
+        munmap(pool->memory_start, pool->memory_mapped_size);
+        free(pool);
+        return NULL;
     }
 
     return pool;
 }
 
-void* pool_alloc(MemoryPool* pool) {
-    // Извлечь первый свободный блок из списка
-    if (!pool || !pool->free_list_head) {
-        return NULL;
+// Учет выданных блоков для фонового потока роста. В однопоточном режиме
+// счетчик пишет только владелец пула, поэтому хватает обычных load/store
+static inline void grow_account(MemoryPool* pool, long delta) {
+    if (!(pool->flags & POOL_GROWABLE)) return;
+    if (pool->flags & POOL_CONCURRENT) {
+        atomic_fetch_add_explicit(&pool->grow_in_use, (size_t)delta, memory_order_relaxed);
+    } else {
+        size_t in_use = atomic_load_explicit(&pool->grow_in_use, memory_order_relaxed);
+        atomic_store_explicit(&pool->grow_in_use, in_use + (size_t)delta, memory_order_relaxed);
+    }
+}
+
+#ifdef POOL_STATS
+static _Atomic unsigned stats_next_slot;
+static _Thread_local unsigned stats_slot; // Номер слота + 1, 0 — еще не назначен
+
+// Слот потока в st_tick. Если потоков больше STATS_TICK_SLOTS, несколько потоков
+// делят слот, и выборка становится приблизительной (счет без атомарного сложения)
+static inline unsigned stats_thread_slot(void) {
+    if (!stats_slot) {
+        stats_slot = atomic_fetch_add_explicit(&stats_next_slot, 1, memory_order_relaxed) % STATS_TICK_SLOTS + 1;
+    }
+    return stats_slot - 1;
+}
+
+// В однопоточном режиме счетчики пишет только владелец пула, поэтому хватает load/store
+static inline void stats_add(const MemoryPool* pool, _Atomic unsigned long long* counter, long delta) {
+    if (pool->flags & POOL_CONCURRENT) {
+        atomic_fetch_add_explicit(counter, (unsigned long long)delta, memory_order_relaxed);
+    } else {
+        unsigned long long value = atomic_load_explicit(counter, memory_order_relaxed);
+        atomic_store_explicit(counter, value + (unsigned long long)delta, memory_order_relaxed);
+    }
+}
+
+// got — выдано блоков, missing — сколько запрошенных блоков не нашлось
+static inline void stats_note_alloc(MemoryPool* pool, size_t got, size_t missing) {
+    if (missing) {
+        stats_add(pool, &pool->st_failed, (long)missing);
+    }
+    if (!got) {
+        return;
+    }
+    stats_add(pool, &pool->st_alloc, (long)got);
+    size_t in_use;
+    if (pool->flags & POOL_CONCURRENT) {
+        in_use = atomic_fetch_add_explicit(&pool->st_in_use, got, memory_order_relaxed) + got;
+    } else {
+        in_use = atomic_load_explicit(&pool->st_in_use, memory_order_relaxed) + got;
+        atomic_store_explicit(&pool->st_in_use, in_use, memory_order_relaxed);
+    }
+    size_t peak = atomic_load_explicit(&pool->st_peak, memory_order_relaxed);
+    while (in_use > peak &&
+           !atomic_compare_exchange_weak_explicit(&pool->st_peak, &peak, in_use,
+                                                  memory_order_relaxed, memory_order_relaxed)) {
+    }
+}
+
+static inline void stats_note_free(MemoryPool* pool, size_t count) {
+    stats_add(pool, &pool->st_free, (long)count);
+    if (pool->flags & POOL_CONCURRENT) {
+        atomic_fetch_sub_explicit(&pool->st_in_use, count, memory_order_relaxed);
+    } else {
+        size_t in_use = atomic_load_explicit(&pool->st_in_use, memory_order_relaxed);
+        atomic_store_explicit(&pool->st_in_use, in_use - count, memory_order_relaxed);
+    }
+}
+
+// Пора ли засечь вызов: каждый st_sample_period-й вызов потока в этом пуле
+static inline int stats_sample_due(MemoryPool* pool) {
+    if (!pool->st_sample_period) return 0;
+    _Atomic unsigned* tick = &pool->st_tick[stats_thread_slot()].value;
+    unsigned count = atomic_load_explicit(tick, memory_order_relaxed) + 1;
+    if (count >= pool->st_sample_period) count = 0;
+    atomic_store_explicit(tick, count, memory_order_relaxed);
+    return count == 0;
+}
+
+// Выделение с учетом в статистике; каждый st_sample_period-й вызов засекается
+static inline void* stats_alloc(MemoryPool* pool, void* (*take)(MemoryPool*)) {
+    void* block;
+    if (stats_sample_due(pool)) {
+        struct timespec start, end;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        block = take(pool);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        unsigned long long ns = (unsigned long long)((end.tv_sec - start.tv_sec) * 1000000000LL +
+                                                     (end.tv_nsec - start.tv_nsec));
+        unsigned bucket = 0;
+        while (ns > 1 && bucket < POOL_STATS_BUCKETS - 1) {
+            ns >>= 1;
+            bucket++;
+        }
+        stats_add(pool, &pool->st_hist[bucket], 1);
+        stats_add(pool, &pool->st_samples, 1);
+    } else {
+        block = take(pool);
     }
+    stats_note_alloc(pool, block != NULL, block == NULL);
+    return block;
+}
+
+#define STATS_ALLOC(pool, take) stats_alloc(pool, take)
+#define STATS_ALLOC_N(pool, got, missing) stats_note_alloc(pool, got, missing)
+#define STATS_FREE(pool, count) stats_note_free(pool, count)
+#else
+#define STATS_ALLOC(pool, take) take(pool)
+#define STATS_ALLOC_N(pool, got, missing) ((void)0)
+#define STATS_FREE(pool, count) ((void)0)
+#endif
+
+static inline void* pool_take(MemoryPool* pool) {
+    // Извлечь первый свободный блок из списка
     Node* block_to_alloc = pool->free_list_head;
-    pool->free_list_head = block_to_alloc->next;
-    return (void*)block_to_alloc;
+    if (block_to_alloc) {
+        pool->free_list_head = block_to_alloc->next;
+        grow_account(pool, 1);
+        return (void*)block_to_alloc;
+    }
+
+    // Ленивый режим: выдать еще не использованный блок
+    if (pool->bump_idx < pool->bump_end) {
+        grow_account(pool, 1);
+        return block_at(pool, pool->bump_idx++);
+    }
+
+    // Растущий пул: забрать целиком цепочку, подготовленную фоновым потоком
+    if (pool->flags & POOL_GROWABLE) {
+        block_to_alloc = atomic_exchange_explicit(&pool->grow_incoming, NULL, memory_order_acquire);
+        if (block_to_alloc) {
+            pool->free_list_head = block_to_alloc->next;
+            grow_account(pool, 1);
+            return (void*)block_to_alloc;
+        }
+    }
+    return NULL;
+}
+
+void* pool_alloc(MemoryPool* pool) {
+    if (!pool) return NULL;
+    return STATS_ALLOC(pool, pool_take);
 }
 
 void pool_free(MemoryPool* pool, void* block) {
@@ -66,12 +592,354 @@ void pool_free(MemoryPool* pool, void* block) {
     Node* node_to_free = (Node*)block;
     node_to_free->next = pool->free_list_head;
     pool->free_list_head = node_to_free;
+    grow_account(pool, -1);
+    STATS_FREE(pool, 1);
+}
+
+size_t pool_alloc_n(MemoryPool* pool, void** blocks, size_t n) {
+    if (!pool) return 0;
+
+    // Снять до n блоков с начала списка: голова списка записывается один раз
+    size_t got = 0;
+    Node* node = pool->free_list_head;
+    while (got < n && node) {
+        blocks[got++] = node;
+        node = node->next;
+    }
+    pool->free_list_head = node;
+
+    // Ленивый режим: остаток выдается бегунком
+    while (got < n && pool->bump_idx < pool->bump_end) {
+        blocks[got++] = block_at(pool, pool->bump_idx++);
+    }
+    grow_account(pool, (long)got);
+
+    // Растущий пул: остаток добирается из цепочки, подготовленной фоновым потоком
+    void* block;
+    while (got < n && (pool->flags & POOL_GROWABLE) && (block = pool_take(pool))) {
+        blocks[got++] = block;
+    }
+    STATS_ALLOC_N(pool, got, n - got);
+    return got;
+}
+
+void pool_free_n(MemoryPool* pool, void** blocks, size_t n) {
+    if (!pool || n == 0) return;
+
+    // Связать блоки в цепочку и присоединить ее к списку одной записью головы
+    Node* head = pool->free_list_head;
+    for (size_t i = n; i-- > 0;) {
+        Node* node = (Node*)blocks[i];
+        node->next = head;
+        head = node;
+    }
+    pool->free_list_head = head;
+    grow_account(pool, -(long)n);
+    STATS_FREE(pool, n);
+}
+
+static inline void* pool_take_mt(MemoryPool* pool) {
+    uint32_t idx = lfstack_pop(&pool->mt_head, pool_link, pool);
+    if (idx != 0) {
+        grow_account(pool, 1);
+        return block_at(pool, idx - 1);
+    }
+
+    // Ленивый режим: бегунок сдвигается одним fetch_add, после исчерпания
+    // счетчик просто продолжает расти за block_count
+    if (atomic_load_explicit(&pool->mt_bump, memory_order_relaxed) < pool->block_count) {
+        size_t next = atomic_fetch_add_explicit(&pool->mt_bump, 1, memory_order_relaxed);
+        if (next < pool->block_count) {
+            grow_account(pool, 1);
+            return block_at(pool, next);
+        }
+    }
+    return NULL;
+}
+
+void* pool_alloc_mt(MemoryPool* pool) {
+    if (!pool) return NULL;
+    return STATS_ALLOC(pool, pool_take_mt);
+}
+
+void pool_free_mt(MemoryPool* pool, void* block) {
+    if (!pool || !block) return;
+
+    // Учет до публикации блока: иначе другой поток успеет выдать его раньше
+    // и пиковое значение окажется завышенным
+    STATS_FREE(pool, 1);
+    uint32_t idx = (uint32_t)block_index(pool, block) + 1;
+    lfstack_push(&pool->mt_head, (_Atomic uint32_t*)block, idx);
+    grow_account(pool, -1);
+}
+
+size_t pool_alloc_mt_n(MemoryPool* pool, void** blocks, size_t n) {
+    if (!pool || n == 0) return 0;
+
+    // Вся пачка снимается со стека одним CAS; ссылки внутри нее уже не меняются
+    size_t got = 0;
+    uint32_t idx = lfstack_pop_n(&pool->mt_head, pool_link, pool, n, &pool->committed_blocks, &got);
+    for (size_t i = 0; i < got; ++i) {
+        blocks[i] = block_at(pool, idx - 1);
+        idx = atomic_load_explicit(pool_link(pool, idx), memory_order_relaxed);
+    }
+
+    // Ленивый режим: остаток — одним fetch_add бегунка
+    if (got < n && atomic_load_explicit(&pool->mt_bump, memory_order_relaxed) < pool->block_count) {
+        size_t next = atomic_fetch_add_explicit(&pool->mt_bump, n - got, memory_order_relaxed);
+        while (got < n && next < pool->block_count) {
+            blocks[got++] = block_at(pool, next++);
+        }
+    }
+    grow_account(pool, (long)got);
+    STATS_ALLOC_N(pool, got, n - got);
+    return got;
+}
+
+void pool_free_mt_n(MemoryPool* pool, void** blocks, size_t n) {
+    if (!pool || n == 0) return;
+
+    // Цепочка связывается локально и кладется в стек одним CAS
+    uint32_t first = (uint32_t)block_index(pool, blocks[0]) + 1;
+    for (size_t i = 0; i + 1 < n; ++i) {
+        uint32_t next = (uint32_t)block_index(pool, blocks[i + 1]) + 1;
+        atomic_store_explicit((_Atomic uint32_t*)blocks[i], next, memory_order_relaxed);
+    }
+    STATS_FREE(pool, n);
+    lfstack_push_chain(&pool->mt_head, (_Atomic uint32_t*)blocks[n - 1], first);
+    grow_account(pool, -(long)n);
+}
+
+int pool_owns(const MemoryPool* pool, const void* ptr) {
+    if (!pool) return 0;
+    const char* start = (const char*)pool->memory_start;
+    size_t size = (pool->flags & POOL_GROWABLE)
+                      ? layout_bytes(pool, atomic_load_explicit(&pool->committed_blocks, memory_order_acquire))
+                      : pool->memory_total_size;
+    return (const char*)ptr >= start && (const char*)ptr < start + size;
+}
+
+size_t pool_block_count(const MemoryPool* pool) {
+    return pool ? atomic_load_explicit(&pool->committed_blocks, memory_order_acquire) : 0;
+}
+
+PoolBacking pool_backing(const MemoryPool* pool) {
+    return pool ? pool->backing : POOL_BACKING_MALLOC;
+}
+
+int pool_stats(const MemoryPool* pool, PoolStats* stats) {
+    memset(stats, 0, sizeof(*stats));
+#ifdef POOL_STATS
+    if (!pool) return -1;
+    stats->in_use = atomic_load_explicit(&pool->st_in_use, memory_order_relaxed);
+    stats->peak_in_use = atomic_load_explicit(&pool->st_peak, memory_order_relaxed);
+    stats->alloc_count = atomic_load_explicit(&pool->st_alloc, memory_order_relaxed);
+    stats->free_count = atomic_load_explicit(&pool->st_free, memory_order_relaxed);
+    stats->failed_count = atomic_load_explicit(&pool->st_failed, memory_order_relaxed);
+    stats->latency_samples = atomic_load_explicit(&pool->st_samples, memory_order_relaxed);
+    for (int i = 0; i < POOL_STATS_BUCKETS; i++) {
+        stats->latency_hist[i] = atomic_load_explicit(&pool->st_hist[i], memory_order_relaxed);
+    }
+    return 0;
+#else
+    (void)pool;
+    return -1;
+#endif
+}
+
+void pool_stats_reset(MemoryPool* pool) {
+#ifdef POOL_STATS
+    if (!pool) return;
+    atomic_store_explicit(&pool->st_peak, atomic_load_explicit(&pool->st_in_use, memory_order_relaxed),
+                          memory_order_relaxed);
+    atomic_store_explicit(&pool->st_alloc, 0, memory_order_relaxed);
+    atomic_store_explicit(&pool->st_free, 0, memory_order_relaxed);
+    atomic_store_explicit(&pool->st_failed, 0, memory_order_relaxed);
+    atomic_store_explicit(&pool->st_samples, 0, memory_order_relaxed);
+    for (int i = 0; i < POOL_STATS_BUCKETS; i++) {
+        atomic_store_explicit(&pool->st_hist[i], 0, memory_order_relaxed);
+    }
+#else
+    (void)pool;
+#endif
+}
+
+// Номера свободных блоков в бит-карту free_map (только при неподвижном пуле)
+static void trim_collect_free(const MemoryPool* pool, unsigned char* free_map) {
+    if (pool->flags & POOL_CONCURRENT) {
+        uint32_t idx = (uint32_t)atomic_load_explicit(&pool->mt_head, memory_order_acquire);
+        while (idx != 0) {
+            free_map[idx - 1] = 1;
+            idx = atomic_load_explicit(pool_link(pool, idx), memory_order_relaxed);
+        }
+    } else {
+        for (Node* node = pool->free_list_head; node; node = node->next) {
+            free_map[block_index(pool, node)] = 1;
+        }
+    }
+}
+
+// Пересобрать список свободных блоков: в него попадают блоки с free_map[i] == 1
+static void trim_rebuild_list(MemoryPool* pool, const unsigned char* free_map) {
+    if (pool->flags & POOL_CONCURRENT) {
+        uint32_t head = 0;
+        for (size_t i = pool->block_count; i-- > 0;) {
+            if (!free_map[i]) continue;
+            atomic_store_explicit(pool_link(pool, (uint32_t)(i + 1)), head, memory_order_relaxed);
+            head = (uint32_t)(i + 1);
+        }
+        uint64_t old_head = atomic_load_explicit(&pool->mt_head, memory_order_relaxed);
+        atomic_store_explicit(&pool->mt_head, lfstack_tagged(old_head, head), memory_order_release);
+    } else {
+        Node* head = NULL;
+        for (size_t i = pool->block_count; i-- > 0;) {
+            if (!free_map[i]) continue;
+            Node* node = (Node*)block_at(pool, i);
+            node->next = head;
+            head = node;
+        }
+        pool->free_list_head = head;
+    }
+}
+
+// Диапазон страниц [first, last], который занимает блок i
+static void trim_block_pages(const MemoryPool* pool, size_t i, size_t page, size_t* first, size_t* last) {
+    char* start = block_at(pool, i);
+    char* end = start + pool->block_size - 1;
+    *first = start < pool->trim_base ? 0 : (size_t)(start - pool->trim_base) / page;
+    *last = end < pool->trim_base ? 0 : (size_t)(end - pool->trim_base) / page;
+}
+
+size_t pool_trim(MemoryPool* pool) {
+    if (!pool || (pool->flags & POOL_GROWABLE) || pool->backing == POOL_BACKING_HUGETLB) {
+        return 0;
+    }
+
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    if (!pool->trim_pages) {
+        // Отдавать можно только страницы, целиком лежащие внутри области
+        uintptr_t start = ((uintptr_t)pool->memory_start + page - 1) & ~(uintptr_t)(page - 1);
+        uintptr_t end = ((uintptr_t)pool->memory_start + pool->memory_total_size) & ~(uintptr_t)(page - 1);
+        if (end <= start) return 0;
+        pool->trim_base = (char*)start;
+        pool->trim_page_count = (end - start) / page;
+        pool->trim_pages = calloc(pool->trim_page_count, 1);
+        pool->trim_parked = calloc(pool->block_count, 1);
+        if (!pool->trim_pages || !pool->trim_parked) {
+            free(pool->trim_pages);
+            free(pool->trim_parked);
+            pool->trim_pages = pool->trim_parked = NULL;
+            return 0;
+        }
+    }
+
+    // Свободны блоки из списка и уже снятые прошлым вызовом; остальные (выданные
+    // и еще не тронутые бегунком) удерживают свои страницы
+    unsigned char* free_map = calloc(pool->block_count, 1);
+    unsigned char* busy = calloc(pool->trim_page_count, 1);
+    if (!free_map || !busy) {
+        free(free_map);
+        free(busy);
+        return 0;
+    }
+    trim_collect_free(pool, free_map);
+    size_t first, last;
+    for (size_t i = 0; i < pool->block_count; ++i) {
+        if (free_map[i] || pool->trim_parked[i]) continue;
+        trim_block_pages(pool, i, page, &first, &last);
+        for (size_t p = first; p <= last && p < pool->trim_page_count; ++p) {
+            busy[p] = 1;
+        }
+    }
+
+    // Отдать ОС непрерывные участки свободных страниц. Заблокированные страницы
+    // MADV_DONTNEED не принимает, поэтому сначала munlock
+    size_t released = 0;
+    for (size_t p = 0; p < pool->trim_page_count;) {
+        if (busy[p] || pool->trim_pages[p]) {
+            ++p;
+            continue;
+        }
+        size_t run = p;
+        while (run < pool->trim_page_count && !busy[run] && !pool->trim_pages[run]) {
+            ++run;
+        }
+        char* addr = pool->trim_base + p * page;
+        size_t length = (run - p) * page;
+        munlock(addr, length);
+        if (madvise(addr, length, MADV_DONTNEED) == 0) {
+            memset(pool->trim_pages + p, 1, run - p);
+            released += length;
+        } else {
+            mlock(addr, length);
+        }
+        p = run;
+    }
+
+    // Свободные блоки на отданных страницах потеряли содержимое (и ссылки списка):
+    // снять их со списка до pool_restore
+    for (size_t i = 0; i < pool->block_count; ++i) {
+        if (!free_map[i]) continue;
+        trim_block_pages(pool, i, page, &first, &last);
+        for (size_t p = first; p <= last && p < pool->trim_page_count; ++p) {
+            if (pool->trim_pages[p]) {
+                pool->trim_parked[i] = 1;
+                free_map[i] = 0;
+                break;
+            }
+        }
+    }
+    trim_rebuild_list(pool, free_map);
+
+    free(free_map);
+    free(busy);
+    return released;
+}
+
+size_t pool_restore(MemoryPool* pool) {
+    if (!pool || !pool->trim_pages) return 0;
+
+    // Вернуть страницы: заблокировать и прогреть, чтобы RT-путь не ловил page faults
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t restored = 0;
+    for (size_t p = 0; p < pool->trim_page_count; ++p) {
+        if (!pool->trim_pages[p]) continue;
+        char* addr = pool->trim_base + p * page;
+        mlock(addr, page);
+        *(volatile char*)addr = 0;
+        pool->trim_pages[p] = 0;
+        restored += page;
+    }
+
+    // Вернуть снятые блоки в список вместе с остальными свободными
+    unsigned char* free_map = calloc(pool->block_count, 1);
+    if (!free_map) return restored;
+    trim_collect_free(pool, free_map);
+    for (size_t i = 0; i < pool->block_count; ++i) {
+        if (pool->trim_parked[i]) {
+            free_map[i] = 1;
+            pool->trim_parked[i] = 0;
+        }
+    }
+    trim_rebuild_list(pool, free_map);
+    free(free_map);
+    return restored;
 }
 
 void pool_destroy(MemoryPool* pool) {
     if (!pool) return;
+    if (pool->flags & POOL_GROWABLE) {
+        atomic_store_explicit(&pool->grow_stop, 1, memory_order_relaxed);
+        pthread_join(pool->grow_thread, NULL);
+    }
     // Разблокировать и освободить всю память
-    munlock(pool->memory_start, pool->memory_total_size);
-    free(pool->memory_start);
+    if (pool->backing == POOL_BACKING_MALLOC) {
+        munlock(pool->memory_start, pool->memory_total_size);
+        free(pool->memory_start);
+    } else {
+        munmap(pool->memory_start, pool->memory_mapped_size);
+    }
+    free(pool->trim_pages);
+    free(pool->trim_parked);
     free(pool);
 }
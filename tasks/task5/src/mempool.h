@@ -5,6 +5,80 @@
 
 typedef struct MemoryPool MemoryPool;
 
+/**
+ * @brief Флаги режима работы пула (поле PoolOptions.flags).
+ */
+enum {
+    /** Потокобезопасный lock-free список свободных блоков (pool_alloc_mt/pool_free_mt). */
+    POOL_CONCURRENT = 1u << 0,
+    /** Область на явных huge pages (MAP_HUGETLB), при их нехватке — THP через madvise.
+     *  Область блокируется и прогревается постранично еще в pool_create_ex(). */
+    POOL_HUGEPAGES = 1u << 1,
+    /** Ленивая разметка: pool_create_ex() не обходит блоки, а новые блоки выдаются
+     *  указателем-"бегунком". Страницы блокируются по первому касанию (MLOCK_ONFAULT). */
+    POOL_LAZY = 1u << 2,
+    /** Растущий пул: фоновый (не RT) поток добавляет заблокированные и прогретые
+     *  блоки, когда свободных становится меньше порога. Несовместим с POOL_HUGEPAGES. */
+    POOL_GROWABLE = 1u << 3,
+};
+
+/**
+ * @brief Чем фактически обеспечена область блоков пула.
+ */
+typedef enum {
+    POOL_BACKING_MALLOC,  ///< Обычная память из malloc (4K страницы).
+    POOL_BACKING_HUGETLB, ///< Явные huge pages (MAP_HUGETLB).
+    POOL_BACKING_THP,     ///< Transparent huge pages (madvise(MADV_HUGEPAGE)).
+    POOL_BACKING_RESERVE, ///< Зарезервированный диапазон mmap, заполняемый по мере роста.
+} PoolBacking;
+
+/**
+ * @brief Дополнительные параметры создания пула.
+ *
+ * Нулевая структура соответствует поведению pool_create().
+ */
+typedef struct {
+    unsigned flags; ///< Комбинация флагов POOL_*.
+
+    // Параметры POOL_GROWABLE (0 — значение по умолчанию)
+    size_t max_block_count;  ///< Предельное количество блоков (по умолчанию 16 * block_count).
+    size_t grow_low_water;   ///< Порог свободных блоков для роста (по умолчанию block_count / 4).
+    size_t grow_chunk;       ///< Блоков за один шаг роста (по умолчанию block_count).
+    unsigned grow_period_us; ///< Период опроса фоновым потоком в мкс (по умолчанию 1000).
+
+    /** Выравнивание начала каждого блока: 0 — блоки плотно упакованы, 64 — каждый блок
+     *  на своих кэш-линиях (нет false sharing между соседями), 4096 — по страницам. */
+    size_t block_align;
+    /** Раскраска кэша: область делится на слэбы этого размера, и каждый следующий слэб
+     *  сдвигается на одну кэш-линию (или block_align), чтобы блоки с одинаковым шагом
+     *  не попадали в одни и те же наборы кэша. 0 — без раскраски. */
+    size_t color_slab_size;
+    /** Гистограмма задержек (только при сборке с POOL_STATS): засекать время каждого
+     *  N-го вызова выделения потока в этом пуле (счет ведется отдельно для каждого пула;
+     *  при числе потоков больше 16 они делят счетчики, и выборка приблизительна).
+     *  0 — гистограмма не ведется. */
+    unsigned stats_sample_period;
+} PoolOptions;
+
+/** Количество корзин гистограммы задержек: корзина k — от 2^k до 2^(k+1) нс. */
+#define POOL_STATS_BUCKETS 32
+
+/**
+ * @brief Снимок статистики пула.
+ *
+ * Статистика собирается, только если пул собран с макросом POOL_STATS; без него
+ * счетчики и замеры полностью исключаются из кода pool_alloc/pool_free.
+ */
+typedef struct {
+    size_t in_use;                     ///< Выдано блоков сейчас.
+    size_t peak_in_use;                ///< Наибольшее число одновременно выданных блоков.
+    unsigned long long alloc_count;    ///< Успешных выделений.
+    unsigned long long free_count;     ///< Освобождений.
+    unsigned long long failed_count;   ///< Выделений, вернувших NULL (пул исчерпан).
+    unsigned long long latency_samples; ///< Сколько выделений попало в гистограмму.
+    unsigned long long latency_hist[POOL_STATS_BUCKETS]; ///< Гистограмма задержек выделения.
+} PoolStats;
+
 /**
  * @brief Создает пул памяти.
  * 
@@ -14,6 +88,16 @@ typedef struct MemoryPool MemoryPool;
  */
 MemoryPool* pool_create(size_t block_size, size_t block_count);
 
+/**
+ * @brief Создает пул памяти с дополнительными параметрами.
+ *
+ * @param block_size Размер одного блока в байтах.
+ * @param block_count Количество блоков в пуле.
+ * @param opts Параметры пула (может быть NULL).
+ * @return Указатель на созданный пул или NULL в случае ошибки.
+ */
+MemoryPool* pool_create_ex(size_t block_size, size_t block_count, const PoolOptions* opts);
+
 /**
  * @brief Выделяет один блок из пула.
  * 
@@ -30,6 +114,142 @@ void* pool_alloc(MemoryPool* pool);
  */
 void pool_free(MemoryPool* pool, void* block);
 
+/**
+ * @brief Потокобезопасно выделяет один блок из пула (lock-free).
+ *
+ * Пул должен быть создан с флагом POOL_CONCURRENT. Голова списка хранится
+ * вместе со счетчиком версий, поэтому операция устойчива к проблеме ABA.
+ *
+ * @param pool Указатель на пул.
+ * @return Указатель на выделенный блок или NULL, если свободных блоков нет.
+ */
+void* pool_alloc_mt(MemoryPool* pool);
+
+/**
+ * @brief Потокобезопасно возвращает блок в пул (lock-free).
+ *
+ * @param pool Указатель на пул, созданный с флагом POOL_CONCURRENT.
+ * @param block Указатель на блок, который нужно освободить.
+ */
+void pool_free_mt(MemoryPool* pool, void* block);
+
+/**
+ * @brief Выделяет до n блоков за один вызов.
+ *
+ * Блоки снимаются с начала списка свободных блоков целой цепочкой, голова
+ * списка обновляется один раз.
+ *
+ * @param pool Указатель на пул.
+ * @param blocks Массив для указателей на выделенные блоки (не меньше n элементов).
+ * @param n Сколько блоков нужно.
+ * @return Сколько блоков выделено (меньше n, если пул исчерпан).
+ */
+size_t pool_alloc_n(MemoryPool* pool, void** blocks, size_t n);
+
+/**
+ * @brief Возвращает в пул n блоков за один вызов.
+ *
+ * @param pool Указатель на пул.
+ * @param blocks Массив указателей на блоки (без NULL).
+ * @param n Количество блоков.
+ */
+void pool_free_n(MemoryPool* pool, void** blocks, size_t n);
+
+/**
+ * @brief Потокобезопасно выделяет до n блоков (lock-free).
+ *
+ * Пачка снимается со списка одним CAS. В режиме POOL_LAZY недостающие блоки
+ * берутся одним fetch_add бегунка.
+ *
+ * @param pool Указатель на пул, созданный с флагом POOL_CONCURRENT.
+ * @param blocks Массив для указателей на выделенные блоки (не меньше n элементов).
+ * @param n Сколько блоков нужно.
+ * @return Сколько блоков выделено (меньше n, если пул исчерпан).
+ */
+size_t pool_alloc_mt_n(MemoryPool* pool, void** blocks, size_t n);
+
+/**
+ * @brief Потокобезопасно возвращает в пул n блоков (lock-free).
+ *
+ * Блоки связываются в цепочку локально, и цепочка кладется в список одним CAS.
+ *
+ * @param pool Указатель на пул, созданный с флагом POOL_CONCURRENT.
+ * @param blocks Массив указателей на блоки (без NULL).
+ * @param n Количество блоков.
+ */
+void pool_free_mt_n(MemoryPool* pool, void** blocks, size_t n);
+
+/**
+ * @brief Проверяет, принадлежит ли адрес области блоков пула.
+ *
+ * @param pool Указатель на пул.
+ * @param ptr Проверяемый адрес.
+ * @return 1, если адрес лежит внутри пула, иначе 0.
+ */
+int pool_owns(const MemoryPool* pool, const void* ptr);
+
+/**
+ * @brief Возвращает тип памяти, на которой фактически размещен пул.
+ *
+ * @param pool Указатель на пул.
+ * @return Тип памяти (для POOL_HUGEPAGES показывает, сработал ли fallback на THP).
+ */
+PoolBacking pool_backing(const MemoryPool* pool);
+
+/**
+ * @brief Возвращает текущее количество блоков пула.
+ *
+ * @param pool Указатель на пул.
+ * @return Количество блоков (в режиме POOL_GROWABLE растет со временем).
+ */
+size_t pool_block_count(const MemoryPool* pool);
+
+/**
+ * @brief Возвращает снимок статистики пула.
+ *
+ * Для POOL_CONCURRENT-пула снимок не атомарен: счетчики читаются по очереди.
+ *
+ * @param pool Указатель на пул.
+ * @param stats Куда записать статистику (обнуляется, если статистика недоступна).
+ * @return 0 при успехе, -1, если библиотека собрана без POOL_STATS.
+ */
+int pool_stats(const MemoryPool* pool, PoolStats* stats);
+
+/**
+ * @brief Обнуляет счетчики статистики; пиковое значение становится равным текущему.
+ *
+ * Вызывать, когда с пулом не работают другие потоки.
+ *
+ * @param pool Указатель на пул.
+ */
+void pool_stats_reset(MemoryPool* pool);
+
+/**
+ * @brief Отдает ОС страницы, на которых нет выданных блоков.
+ *
+ * Находит участки страниц, целиком занятые свободными блоками, снимает с них
+ * блокировку и освобождает через madvise(MADV_DONTNEED). Свободные блоки на этих
+ * страницах убираются из списка, поэтому до pool_restore() пул меньше.
+ * Вызывать вне RT-цикла, когда с пулом не работают другие потоки. Не действует
+ * для POOL_GROWABLE и пулов на явных huge pages.
+ *
+ * @param pool Указатель на пул.
+ * @return Сколько байт отдано ОС этим вызовом.
+ */
+size_t pool_trim(MemoryPool* pool);
+
+/**
+ * @brief Возвращает страницы, отданные pool_trim(), и их блоки.
+ *
+ * Страницы снова блокируются и прогреваются, поэтому после вызова pool_alloc()
+ * не получает page faults. Вызывать вне RT-цикла перед очередным пиком нагрузки,
+ * когда с пулом не работают другие потоки.
+ *
+ * @param pool Указатель на пул.
+ * @return Сколько байт возвращено.
+ */
+size_t pool_restore(MemoryPool* pool);
+
 /**
  * @brief Уничтожает пул и освобождает всю выделенную под него память.
  * 
@@ -0,0 +1,116 @@
+#include "objcache.h"
+#include <stdalign.h>
+#include <stdlib.h>
+
+// Префикс перед объектом: в нем пул хранит ссылку, пока блок свободен
+#define OBJ_PREFIX alignof(max_align_t)
+
+struct ObjCache {
+    MemoryPool* pool;
+    size_t count;
+    int concurrent;
+    ObjDtor dtor;
+    void* arg;
+};
+
+static inline void* block_object(void* block) {
+    return (char*)block + OBJ_PREFIX;
+}
+
+static inline void* object_block(void* obj) {
+    return (char*)obj - OBJ_PREFIX;
+}
+
+// Разрушить первые constructed объектов. Блоки в пул не возвращаются: следом идет pool_destroy()
+static void objcache_release(ObjCache* cache, void** blocks, size_t constructed) {
+    if (cache->dtor) {
+        for (size_t i = 0; i < constructed; ++i) {
+            cache->dtor(block_object(blocks[i]), cache->arg);
+        }
+    }
+}
+
+ObjCache* objcache_create(size_t object_size, size_t count, ObjCtor ctor, ObjDtor dtor,
+                          void* arg, const PoolOptions* opts) {
+    if (object_size == 0 || count == 0) return NULL;
+    if (opts && (opts->flags & (POOL_LAZY | POOL_GROWABLE))) return NULL;
+
+    // Шаг блоков кратен префиксу, чтобы объекты сохраняли выравнивание max_align_t
+    PoolOptions pool_opts = opts ? *opts : (PoolOptions){ 0 };
+    if (pool_opts.block_align < OBJ_PREFIX) {
+        pool_opts.block_align = OBJ_PREFIX;
+    }
+
+    ObjCache* cache = (ObjCache*)malloc(sizeof(ObjCache));
+    void** blocks = (void**)malloc(count * sizeof(void*));
+    if (!cache || !blocks) {
+        free(cache);
+        free(blocks);
+        return NULL;
+    }
+    cache->pool = pool_create_ex(OBJ_PREFIX + object_size, count, &pool_opts);
+    cache->count = count;
+    cache->concurrent = (pool_opts.flags & POOL_CONCURRENT) != 0;
+    cache->dtor = dtor;
+    cache->arg = arg;
+    if (!cache->pool) {
+        free(blocks);
+        free(cache);
+        return NULL;
+    }
+
+    // Сконструировать все объекты сейчас, вне RT-цикла
+    size_t got = cache->concurrent ? pool_alloc_mt_n(cache->pool, blocks, count)
+                                   : pool_alloc_n(cache->pool, blocks, count);
+    size_t constructed = 0;
+    if (ctor) {
+        while (constructed < got && ctor(block_object(blocks[constructed]), arg) == 0) {
+            ++constructed;
+        }
+    } else {
+        constructed = got;
+    }
+    if (got != count || constructed != got) {
+        objcache_release(cache, blocks, constructed);
+        pool_destroy(cache->pool);
+        free(blocks);
+        free(cache);
+        return NULL;
+    }
+    if (cache->concurrent) {
+        pool_free_mt_n(cache->pool, blocks, got);
+    } else {
+        pool_free_n(cache->pool, blocks, got);
+    }
+    free(blocks);
+    return cache;
+}
+
+void* objcache_alloc(ObjCache* cache) {
+    if (!cache) return NULL;
+    void* block = cache->concurrent ? pool_alloc_mt(cache->pool) : pool_alloc(cache->pool);
+    return block ? block_object(block) : NULL;
+}
+
+void objcache_free(ObjCache* cache, void* obj) {
+    if (!cache || !obj) return;
+    if (cache->concurrent) {
+        pool_free_mt(cache->pool, object_block(obj));
+    } else {
+        pool_free(cache->pool, object_block(obj));
+    }
+}
+
+void objcache_destroy(ObjCache* cache) {
+    if (!cache) return;
+    // Объекты забираются из пула по одному: без временного массива деструкторы
+    // вызываются и тогда, когда память уже не выделяется
+    if (cache->dtor) {
+        void* block;
+        while ((block = cache->concurrent ? pool_alloc_mt(cache->pool) : pool_alloc(cache->pool)) != NULL) {
+            cache->dtor(block_object(block), cache->arg);
+        }
+    }
+    pool_destroy(cache->pool);
+    free(cache);
+}
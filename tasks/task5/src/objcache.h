@@ -0,0 +1,69 @@
+#ifndef OBJCACHE_H
+#define OBJCACHE_H
+
+#include <stddef.h>
+#include "mempool.h"
+
+/*
+ * Кэш объектов поверх MemoryPool с сохранением сконструированного состояния.
+ *
+ * Конструктор вызывается для каждого объекта один раз — когда блок попадает
+ * в кэш (при objcache_create(), вне RT-цикла). objcache_free() возвращает объект
+ * в кэш без разрушения: следующий objcache_alloc() получит его уже готовым
+ * (инициализированные мьютексы, таблицы, буферы). Деструктор вызывается только
+ * при уничтожении кэша. Пользователь сам сбрасывает поля, которые меняются
+ * от использования к использованию.
+ *
+ * Ссылка списка свободных блоков пула хранится в служебном префиксе перед
+ * объектом, поэтому освобождение не портит содержимое объекта.
+ */
+
+typedef struct ObjCache ObjCache;
+
+/** Конструктор: готовит объект к использованию; возвращает 0 при успехе. */
+typedef int (*ObjCtor)(void* obj, void* arg);
+/** Деструктор: освобождает ресурсы объекта, захваченные конструктором. */
+typedef void (*ObjDtor)(void* obj, void* arg);
+
+/**
+ * @brief Создает кэш и конструирует все его объекты.
+ *
+ * @param object_size Размер объекта в байтах.
+ * @param count Количество объектов.
+ * @param ctor Конструктор (может быть NULL).
+ * @param dtor Деструктор (может быть NULL).
+ * @param arg Аргумент, передаваемый в ctor и dtor.
+ * @param opts Параметры пула (может быть NULL). С POOL_CONCURRENT кэш потокобезопасен.
+ *             POOL_LAZY и POOL_GROWABLE не поддерживаются: все объекты
+ *             конструируются заранее.
+ * @return Указатель на кэш или NULL в случае ошибки (в т.ч. если конструктор вернул ошибку).
+ */
+ObjCache* objcache_create(size_t object_size, size_t count, ObjCtor ctor, ObjDtor dtor,
+                          void* arg, const PoolOptions* opts);
+
+/**
+ * @brief Выдает сконструированный объект.
+ *
+ * @param cache Указатель на кэш.
+ * @return Указатель на объект или NULL, если свободных объектов нет.
+ */
+void* objcache_alloc(ObjCache* cache);
+
+/**
+ * @brief Возвращает объект в кэш в сконструированном состоянии.
+ *
+ * @param cache Указатель на кэш.
+ * @param obj Указатель на объект.
+ */
+void objcache_free(ObjCache* cache, void* obj);
+
+/**
+ * @brief Вызывает деструктор для всех объектов и уничтожает кэш.
+ *
+ * К моменту вызова все объекты должны быть возвращены в кэш.
+ *
+ * @param cache Указатель на кэш.
+ */
+void objcache_destroy(ObjCache* cache);
+
+#endif // OBJCACHE_H
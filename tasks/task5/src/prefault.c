@@ -0,0 +1,126 @@
+#define _GNU_SOURCE
+#include "prefault.h"
+#include <errno.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#ifndef MADV_POPULATE_WRITE
+#define MADV_POPULATE_WRITE 23
+#endif
+
+#define PARALLEL_MIN_CHUNK (64UL * 1024 * 1024) // Меньшую долю на поток заполнять параллельно не выгодно
+#define PARALLEL_MAX_THREADS 64
+
+// Участок области для одного потока параллельного заполнения
+typedef struct {
+    char* addr;
+    size_t size;
+    int result;
+} PrefaultChunk;
+
+static void touch_pages(char* addr, size_t size) {
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    for (size_t off = 0; off < size; off += page) {
+        ((volatile char*)addr)[off] = 0;
+    }
+}
+
+static int populate_write(char* addr, size_t size) {
+    if (madvise(addr, size, MADV_POPULATE_WRITE) == 0) return 0;
+    // EINVAL — ядро старше 5.14, заполняем записью
+    if (errno != EINVAL) return -1;
+    touch_pages(addr, size);
+    return 0;
+}
+
+static void* prefault_worker(void* arg) {
+    PrefaultChunk* chunk = (PrefaultChunk*)arg;
+    chunk->result = populate_write(chunk->addr, chunk->size);
+    return NULL;
+}
+
+static int populate_parallel(char* addr, size_t size, int threads) {
+    if (threads <= 0) threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (threads > PARALLEL_MAX_THREADS) threads = PARALLEL_MAX_THREADS;
+    if (threads <= 1) return populate_write(addr, size);
+
+    // Границы участков по huge page, чтобы потоки не делили одну THP
+    size_t align = 2UL * 1024 * 1024;
+    size_t chunk_size = (size / (size_t)threads + align - 1) & ~(align - 1);
+    PrefaultChunk chunks[PARALLEL_MAX_THREADS];
+    pthread_t tids[PARALLEL_MAX_THREADS];
+    int started = 0;
+    int result = 0;
+
+    for (size_t off = 0; off < size && started < threads; off += chunk_size) {
+        PrefaultChunk* chunk = &chunks[started];
+        chunk->addr = addr + off;
+        chunk->size = size - off < chunk_size ? size - off : chunk_size;
+        chunk->result = 0;
+        if (pthread_create(&tids[started], NULL, prefault_worker, chunk) != 0) {
+            // Поток не создался — этот участок заполняет вызывающий поток
+            if (populate_write(chunk->addr, chunk->size) != 0) {
+                result = -1;
+                break;
+            }
+            continue;
+        }
+        started++;
+    }
+
+    for (int i = 0; i < started; ++i) {
+        pthread_join(tids[i], NULL);
+        if (chunks[i].result != 0) result = -1;
+    }
+    return result;
+}
+
+int prefault_range(void* addr, size_t size, PrefaultMethod method, int threads) {
+    if (!addr || size == 0) return -1;
+    switch (method) {
+    case PREFAULT_TOUCH:
+        touch_pages((char*)addr, size);
+        return 0;
+    case PREFAULT_MAP_POPULATE:
+    case PREFAULT_MADVISE:
+        return populate_write((char*)addr, size);
+    case PREFAULT_PARALLEL:
+        return populate_parallel((char*)addr, size, threads);
+    }
+    return -1;
+}
+
+void* prefault_map(size_t size, PrefaultMethod method, int threads) {
+    int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+    if (method == PREFAULT_MAP_POPULATE) flags |= MAP_POPULATE;
+
+    void* addr = mmap(NULL, size, PROT_READ | PROT_WRITE, flags, -1, 0);
+    if (addr == MAP_FAILED) return NULL;
+    if (method == PREFAULT_MAP_POPULATE) return addr;
+
+    if (prefault_range(addr, size, method, threads) != 0) {
+        munmap(addr, size);
+        return NULL;
+    }
+    return addr;
+}
+
+void* prefault_alloc(size_t size) {
+    if (size < 2 * PARALLEL_MIN_CHUNK) return prefault_map(size, PREFAULT_MADVISE, 1);
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    size_t threads = size / PARALLEL_MIN_CHUNK;
+    if (cpus > 0 && threads > (size_t)cpus) threads = (size_t)cpus;
+    return prefault_map(size, PREFAULT_PARALLEL, (int)threads);
+}
+
+const char* prefault_method_name(PrefaultMethod method) {
+    switch (method) {
+    case PREFAULT_TOUCH: return "touch loop";
+    case PREFAULT_MAP_POPULATE: return "MAP_POPULATE";
+    case PREFAULT_MADVISE: return "MADV_POPULATE_WRITE";
+    case PREFAULT_PARALLEL: return "parallel";
+    }
+    return "unknown";
+}
@@ -0,0 +1,64 @@
+#ifndef PREFAULT_H
+#define PREFAULT_H
+
+#include <stddef.h>
+
+/*
+ * Предварительное заполнение (prefault) больших областей памяти.
+ *
+ * Цикл записи по байту на страницу платит за каждую страницу полным
+ * отказом: переход в ядро, обработку и возврат. MAP_POPULATE и
+ * madvise(MADV_POPULATE_WRITE) заполняют таблицы страниц внутри одного
+ * системного вызова, а параллельное заполнение делит область между
+ * потоками, и страницы обнуляются на нескольких ядрах сразу.
+ */
+
+/** Способ заполнения области. */
+typedef enum {
+    PREFAULT_TOUCH,        ///< Запись по байту на страницу в одном потоке
+    PREFAULT_MAP_POPULATE, ///< mmap(MAP_POPULATE); только для prefault_map()
+    PREFAULT_MADVISE,      ///< madvise(MADV_POPULATE_WRITE), Linux 5.14+
+    PREFAULT_PARALLEL      ///< Область делится между потоками, каждый — MADV_POPULATE_WRITE
+} PrefaultMethod;
+
+/**
+ * @brief Заполняет страницы уже отображенной области для записи.
+ *
+ * Если ядро не поддерживает MADV_POPULATE_WRITE, PREFAULT_MADVISE и
+ * PREFAULT_PARALLEL откатываются на запись по байту на страницу.
+ *
+ * @param addr Начало области.
+ * @param size Размер области в байтах.
+ * @param method Способ заполнения (PREFAULT_MAP_POPULATE работает как PREFAULT_MADVISE).
+ * @param threads Число потоков для PREFAULT_PARALLEL (0 — по числу процессоров).
+ * @return 0 в случае успеха, -1 в случае ошибки.
+ */
+int prefault_range(void* addr, size_t size, PrefaultMethod method, int threads);
+
+/**
+ * @brief Отображает анонимную область и заполняет ее выбранным способом.
+ *
+ * @param size Размер области в байтах.
+ * @param method Способ заполнения.
+ * @param threads Число потоков для PREFAULT_PARALLEL (0 — по числу процессоров).
+ * @return Указатель на область (освобождается munmap()) или NULL в случае ошибки.
+ */
+void* prefault_map(size_t size, PrefaultMethod method, int threads);
+
+/**
+ * @brief Отображает и заполняет область самым быстрым способом.
+ *
+ * Большие области заполняются параллельно на всех процессорах, небольшие —
+ * одним madvise(MADV_POPULATE_WRITE), где создание потоков не окупается.
+ *
+ * @param size Размер области в байтах.
+ * @return Указатель на область (освобождается munmap()) или NULL в случае ошибки.
+ */
+void* prefault_alloc(size_t size);
+
+/**
+ * @brief Возвращает имя способа заполнения для вывода.
+ */
+const char* prefault_method_name(PrefaultMethod method);
+
+#endif // PREFAULT_H
@@ -0,0 +1,210 @@
+#define _GNU_SOURCE
+#include "rtmalloc.h"
+#include "tlsf.h"
+#include <dlfcn.h>
+#include <errno.h>
+#include <malloc.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+// Реализация glibc, в которую уходят запросы мимо арены
+extern void* __libc_malloc(size_t size);
+extern void* __libc_calloc(size_t count, size_t size);
+extern void* __libc_realloc(void* ptr, size_t size);
+extern void* __libc_memalign(size_t align, size_t size);
+extern void __libc_free(void* ptr);
+
+static Tlsf* arena;
+static size_t arena_free_initial; // tlsf_free_bytes() сразу после создания
+static pthread_mutex_t arena_lock;
+static pthread_once_t arena_once = PTHREAD_ONCE_INIT;
+static RtMallocStats stats;
+
+// Создание арены. Вызывается из первого malloc, поэтому ничего не выделяет
+static void arena_init(void) {
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    // RT-поток не должен ждать освобождения мьютекса низкоприоритетным потоком
+    pthread_mutexattr_setprotocol(&attr, PTHREAD_PRIO_INHERIT);
+    pthread_mutex_init(&arena_lock, &attr);
+    pthread_mutexattr_destroy(&attr);
+
+    size_t mb = RTMALLOC_DEFAULT_ARENA_MB;
+    const char* env = getenv("RTMALLOC_ARENA_MB");
+    if (env && *env) {
+        mb = (size_t)strtoul(env, NULL, 10);
+    }
+    arena = tlsf_create(mb * 1024 * 1024);
+    if (arena) {
+        arena_free_initial = tlsf_free_bytes(arena);
+        stats.arena_size = arena_free_initial;
+    }
+}
+
+static inline void arena_lock_init(void) {
+    pthread_once(&arena_once, arena_init);
+}
+
+// Учет выделения из арены; вызывается под arena_lock
+static inline void account_alloc(void) {
+    stats.allocs++;
+    stats.arena_used = arena_free_initial - tlsf_free_bytes(arena);
+    if (stats.arena_used > stats.arena_peak) {
+        stats.arena_peak = stats.arena_used;
+    }
+}
+
+static inline void account_fallback(size_t size) {
+    arena_lock_init();
+    pthread_mutex_lock(&arena_lock);
+    stats.fallbacks++;
+    stats.fallback_bytes += size;
+    pthread_mutex_unlock(&arena_lock);
+}
+
+// Выделение из арены с выравниванием align; NULL, если места нет
+static void* arena_alloc(size_t align, size_t size) {
+    arena_lock_init();
+    if (!arena) return NULL;
+    if (size == 0) size = 1;
+    pthread_mutex_lock(&arena_lock);
+    void* ptr = tlsf_alloc_aligned(arena, align, size);
+    if (ptr) account_alloc();
+    pthread_mutex_unlock(&arena_lock);
+    return ptr;
+}
+
+static inline int arena_owns(const void* ptr) {
+    return arena && tlsf_owns(arena, ptr);
+}
+
+static void arena_free(void* ptr) {
+    pthread_mutex_lock(&arena_lock);
+    tlsf_free(arena, ptr);
+    stats.arena_used = arena_free_initial - tlsf_free_bytes(arena);
+    pthread_mutex_unlock(&arena_lock);
+}
+
+void* malloc(size_t size) {
+    void* ptr = arena_alloc(0, size);
+    if (ptr) return ptr;
+    account_fallback(size);
+    return __libc_malloc(size);
+}
+
+void free(void* ptr) {
+    if (!ptr) return;
+    if (arena_owns(ptr)) {
+        arena_free(ptr);
+    } else {
+        __libc_free(ptr);
+    }
+}
+
+void* calloc(size_t count, size_t size) {
+    size_t total;
+    if (__builtin_mul_overflow(count, size, &total)) {
+        errno = ENOMEM;
+        return NULL;
+    }
+    void* ptr = arena_alloc(0, total);
+    if (ptr) {
+        // Блоки арены переиспользуются и не обнуляются сами
+        memset(ptr, 0, total);
+        return ptr;
+    }
+    account_fallback(total);
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* ptr, size_t size) {
+    if (!ptr) return malloc(size);
+    if (size == 0) {
+        free(ptr);
+        return NULL;
+    }
+    if (!arena_owns(ptr)) {
+        account_fallback(size);
+        return __libc_realloc(ptr, size);
+    }
+
+    size_t old_size = tlsf_usable_size(ptr);
+    if (size <= old_size) return ptr;
+    void* moved = malloc(size);
+    if (!moved) return NULL;
+    memcpy(moved, ptr, old_size);
+    arena_free(ptr);
+    return moved;
+}
+
+void* reallocarray(void* ptr, size_t count, size_t size) {
+    size_t total;
+    if (__builtin_mul_overflow(count, size, &total)) {
+        errno = ENOMEM;
+        return NULL;
+    }
+    return realloc(ptr, total);
+}
+
+void* memalign(size_t align, size_t size) {
+    if (align & (align - 1)) {
+        errno = EINVAL;
+        return NULL;
+    }
+    void* ptr = arena_alloc(align, size);
+    if (ptr) return ptr;
+    account_fallback(size);
+    return __libc_memalign(align, size);
+}
+
+int posix_memalign(void** out, size_t align, size_t size) {
+    if (align < sizeof(void*) || (align & (align - 1))) return EINVAL;
+    void* ptr = memalign(align, size);
+    if (!ptr) return ENOMEM;
+    *out = ptr;
+    return 0;
+}
+
+void* aligned_alloc(size_t align, size_t size) {
+    return memalign(align, size);
+}
+
+void* valloc(size_t size) {
+    return memalign((size_t)sysconf(_SC_PAGESIZE), size);
+}
+
+void* pvalloc(size_t size) {
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    return memalign(page, (size + page - 1) & ~(page - 1));
+}
+
+size_t malloc_usable_size(void* ptr) {
+    if (!ptr) return 0;
+    if (arena_owns(ptr)) return tlsf_usable_size(ptr);
+    // Указатель glibc: ее версия функции, найденная в следующей библиотеке
+    static size_t (*libc_usable_size)(void*);
+    if (!libc_usable_size) {
+        libc_usable_size = (size_t (*)(void*))dlsym(RTLD_NEXT, "malloc_usable_size");
+        if (!libc_usable_size) return 0;
+    }
+    return libc_usable_size(ptr);
+}
+
+void rtmalloc_stats(RtMallocStats* out) {
+    arena_lock_init();
+    pthread_mutex_lock(&arena_lock);
+    *out = stats;
+    pthread_mutex_unlock(&arena_lock);
+}
+
+// Итог при завершении: сколько запросов прошло мимо арены
+__attribute__((destructor)) static void rtmalloc_report(void) {
+    if (getenv("RTMALLOC_QUIET")) return;
+    RtMallocStats s;
+    rtmalloc_stats(&s);
+    fprintf(stderr, "rtmalloc: arena %zu KB, peak %zu KB, %llu allocs, %llu fallbacks to glibc (%llu bytes)\n",
+            s.arena_size / 1024, s.arena_peak / 1024, s.allocs, s.fallbacks, s.fallback_bytes);
+}
@@ -0,0 +1,52 @@
+#ifndef RTMALLOC_H
+#define RTMALLOC_H
+
+#include <stddef.h>
+
+/*
+ * Подменяемый malloc для RT-процессов (librtmalloc.so, подключается через
+ * LD_PRELOAD).
+ *
+ * Сторонний код внутри RT-процесса вызывает malloc/free, а glibc при этом
+ * может расширить кучу через brk/mmap или отдать память ОС (trim), и в
+ * RT-цикле появляются отказы и системные вызовы. Библиотека обслуживает
+ * malloc, calloc, realloc, free и функции выделения с выравниванием из
+ * одной арены TLSF (tlsf.h): она создается при первом вызове malloc,
+ * сразу блокируется и прогревается и никогда не возвращает память ОС.
+ * Выделение и освобождение — O(1) под одним мьютексом с наследованием
+ * приоритета.
+ *
+ * Если арена заполнена или не создалась, запрос уходит в glibc
+ * (__libc_malloc и др.). Такие обращения считаются: это единственный путь,
+ * по которому выделение может дойти до ОС. Указатели glibc, в том числе
+ * выделенные до загрузки библиотеки, освобождаются через __libc_free.
+ *
+ * Переменные окружения:
+ *   RTMALLOC_ARENA_MB — размер арены в МБ (по умолчанию RTMALLOC_DEFAULT_ARENA_MB);
+ *   RTMALLOC_QUIET    — не печатать итог в stderr при завершении процесса.
+ *
+ * Программа, загруженная с библиотекой, может получить счетчики через
+ * dlsym(RTLD_DEFAULT, "rtmalloc_stats").
+ */
+
+/** Размер арены по умолчанию, МБ. */
+#define RTMALLOC_DEFAULT_ARENA_MB 64
+
+/** Счетчики арены. */
+typedef struct {
+    size_t arena_size;                ///< Полезный размер арены (0, если она не создана).
+    size_t arena_used;                ///< Занято сейчас, с заголовками блоков.
+    size_t arena_peak;                ///< Наибольшая занятость.
+    unsigned long long allocs;        ///< Выделений из арены.
+    unsigned long long fallbacks;     ///< Выделений через glibc.
+    unsigned long long fallback_bytes; ///< Запрошено байт через glibc.
+} RtMallocStats;
+
+/**
+ * @brief Возвращает счетчики арены.
+ *
+ * @param stats Куда записать счетчики.
+ */
+void rtmalloc_stats(RtMallocStats* stats);
+
+#endif // RTMALLOC_H
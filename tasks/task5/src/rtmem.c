@@ -0,0 +1,136 @@
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include "rtmem.h"
+#include <errno.h>
+#include <malloc.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+
+#ifndef MCL_ONFAULT
+#define MCL_ONFAULT 4
+#endif
+#ifndef MLOCK_ONFAULT
+#define MLOCK_ONFAULT 1
+#endif
+
+#define STACK_GUARD (64 * 1024) // Запас до предела стека главного потока
+
+// Отдельная функция, чтобы массив лег ниже кадра вызывающего и не был убран оптимизатором
+static void __attribute__((noinline)) touch_stack(size_t depth) {
+    char frame[depth];
+    volatile char* p = frame;
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    for (size_t off = 0; off < depth; off += page) {
+        p[off] = 0;
+    }
+    p[depth - 1] = 0;
+}
+
+// Для главного потока глубина ограничивается RLIMIT_STACK с запасом
+static size_t stack_depth_limit(size_t depth) {
+    if (getpid() == (pid_t)syscall(SYS_gettid)) {
+        struct rlimit limit;
+        if (getrlimit(RLIMIT_STACK, &limit) == 0 && limit.rlim_cur != RLIM_INFINITY) {
+            size_t max = limit.rlim_cur > STACK_GUARD ? (size_t)limit.rlim_cur - STACK_GUARD : 0;
+            if (depth > max) depth = max;
+        }
+    }
+    return depth;
+}
+
+void rtmem_prefault_stack(size_t depth) {
+    depth = stack_depth_limit(depth);
+    if (depth > 0) touch_stack(depth);
+}
+
+int rtmem_lock_stack(size_t depth) {
+    depth = stack_depth_limit(depth);
+    if (depth == 0) return 0;
+    // Сначала расширить стек касанием: mlock не работает с еще не отображенной частью
+    touch_stack(depth);
+
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    char marker;
+    uintptr_t top = ((uintptr_t)&marker + page - 1) & ~(uintptr_t)(page - 1);
+    uintptr_t bottom = ((uintptr_t)&marker - depth) & ~(uintptr_t)(page - 1);
+    return mlock((void*)bottom, top - bottom);
+}
+
+int rtmem_lock_region(void* addr, size_t size, unsigned flags) {
+    if (!addr || size == 0) return -1;
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    uintptr_t start = (uintptr_t)addr & ~(uintptr_t)(page - 1);
+    uintptr_t end = ((uintptr_t)addr + size + page - 1) & ~(uintptr_t)(page - 1);
+
+    // mlock() заполняет страницы для записи без изменения их содержимого
+    if (flags & RTMEM_REGION_PREFAULT) return mlock((void*)start, end - start);
+    return mlock2((void*)start, end - start, MLOCK_ONFAULT);
+}
+
+static int reserve_heap(size_t size, int lock) {
+    char* heap = (char*)malloc(size);
+    if (!heap) return -1;
+    int result = 0;
+    if (lock) {
+        // Блокировка диапазона переживает free(): страницы остаются в куче
+        result = rtmem_lock_region(heap, size, RTMEM_REGION_PREFAULT);
+    } else {
+        size_t page = (size_t)sysconf(_SC_PAGESIZE);
+        for (size_t off = 0; off < size; off += page) {
+            ((volatile char*)heap)[off] = 0;
+        }
+    }
+    // M_TRIM_THRESHOLD = -1: после free() страницы остаются в куче
+    free(heap);
+    return result;
+}
+
+int rtmem_init(const RtMemOptions* opts) {
+    RtMemOptions o = opts ? *opts : (RtMemOptions){0};
+    if (o.stack_prefault == 0) o.stack_prefault = RTMEM_DEFAULT_STACK_PREFAULT;
+    if (o.heap_reserve == 0) o.heap_reserve = RTMEM_DEFAULT_HEAP_RESERVE;
+
+    // До первых крупных выделений, чтобы резерв кучи пришел из brk, а не из mmap
+    if (!(o.flags & RTMEM_KEEP_MALLOC)) {
+        mallopt(M_TRIM_THRESHOLD, -1);
+        mallopt(M_MMAP_MAX, 0);
+    }
+
+    if (o.flags & RTMEM_SELECTIVE) {
+        // Без mlockall: блокируются только стек и резерв кучи, остальное — вызовом
+        // rtmem_lock_region() для каждой горячей области
+        int result = rtmem_lock_stack(o.stack_prefault);
+        if (reserve_heap(o.heap_reserve, 1) != 0) result = -1;
+        return result;
+    }
+
+    int result = 0;
+    int lock_errno = 0;
+    int lock_flags = MCL_CURRENT | MCL_FUTURE | ((o.flags & RTMEM_LOCK_ONFAULT) ? MCL_ONFAULT : 0);
+    if (mlockall(lock_flags) != 0) {
+        result = -1;
+        lock_errno = errno;
+    }
+
+    if (o.thread_stack_size) {
+        pthread_attr_t attr;
+        if (pthread_attr_init(&attr) == 0) {
+            if (pthread_attr_setstacksize(&attr, o.thread_stack_size) == 0) {
+                pthread_setattr_default_np(&attr);
+            }
+            pthread_attr_destroy(&attr);
+        }
+    }
+
+    rtmem_prefault_stack(o.stack_prefault);
+    reserve_heap(o.heap_reserve, 0);
+
+    if (result != 0) errno = lock_errno;
+    return result;
+}
@@ -0,0 +1,115 @@
+#ifndef RTMEM_H
+#define RTMEM_H
+
+#include <stddef.h>
+
+/*
+ * Подготовка памяти процесса к RT-циклу, выполняемая один раз при старте.
+ *
+ * rtmem_init() выполняет все шаги, после которых RT-код не должен получать
+ * page faults:
+ *   1. mallopt(M_TRIM_THRESHOLD, -1) и mallopt(M_MMAP_MAX, 0): free() не
+ *      возвращает память ОС, а крупные malloc() берутся из кучи, а не из
+ *      новых mmap, которые пришлось бы заново заполнять;
+ *   2. mlockall(MCL_CURRENT | MCL_FUTURE);
+ *   3. только если задан thread_stack_size: размер стека новых потоков по
+ *      умолчанию (pthread_setattr_default_np), чтобы MCL_FUTURE не блокировал
+ *      по 8 МБ на каждый поток;
+ *   4. prefault стека вызывающего потока на заданную глубину;
+ *   5. резерв кучи: блок malloc() заданного размера прогревается и
+ *      освобождается, оставаясь в куче заблокированным.
+ *
+ * Стек каждого RT-потока прогревается в начале его функции вызовом
+ * rtmem_prefault_stack().
+ *
+ * mlockall() держит в RAM все: холодный код, одноразовые буферы
+ * инициализации, стеки по 8 МБ. В режиме RTMEM_SELECTIVE блокируются только
+ * стек и резерв кучи, а горячие области (пулы, кольцевые буферы) приложение
+ * блокирует само через rtmem_lock_region(). RSS тогда близок к рабочему
+ * набору RT-пути.
+ */
+
+/** Глубина prefault стека по умолчанию. */
+#define RTMEM_DEFAULT_STACK_PREFAULT (256 * 1024)
+/** Размер резерва кучи по умолчанию. */
+#define RTMEM_DEFAULT_HEAP_RESERVE (8 * 1024 * 1024)
+
+/**
+ * @brief Флаги rtmem_init() (поле RtMemOptions.flags).
+ */
+enum {
+    /** Блокировать страницы по первому касанию (MCL_ONFAULT): отображения, которые
+     *  заполняются лениво (POOL_LAZY), не прогреваются целиком при создании. */
+    RTMEM_LOCK_ONFAULT = 1u << 0,
+    /** Не менять настройки malloc (шаг 1): освобожденная память возвращается ОС,
+     *  и последующие выделения не переиспользуют уже резидентные страницы кучи. */
+    RTMEM_KEEP_MALLOC = 1u << 1,
+    /** Не вызывать mlockall(): стек вызывающего потока и резерв кучи блокируются
+     *  по отдельности, остальные горячие области — через rtmem_lock_region(). */
+    RTMEM_SELECTIVE = 1u << 2,
+};
+
+/**
+ * @brief Флаги rtmem_lock_region().
+ */
+enum {
+    /** Сразу заполнить и заблокировать всю область (mlock). Без флага страницы
+     *  блокируются по первому касанию (mlock2(MLOCK_ONFAULT)), и это касание
+     *  еще стоит minor fault. */
+    RTMEM_REGION_PREFAULT = 1u << 0,
+};
+
+/**
+ * @brief Параметры rtmem_init().
+ *
+ * Нулевые поля означают значения по умолчанию.
+ */
+typedef struct {
+    unsigned flags;           ///< Комбинация флагов RTMEM_*.
+    size_t stack_prefault;    ///< Глубина prefault стека (по умолчанию RTMEM_DEFAULT_STACK_PREFAULT).
+    size_t heap_reserve;      ///< Резерв кучи в байтах (по умолчанию RTMEM_DEFAULT_HEAP_RESERVE).
+    size_t thread_stack_size; ///< Размер стека новых потоков (0 — размер по умолчанию не меняется).
+} RtMemOptions;
+
+/**
+ * @brief Настраивает память процесса для RT-работы.
+ *
+ * Если mlockall() не удался (нет CAP_IPC_LOCK, мал RLIMIT_MEMLOCK), остальные
+ * шаги все равно выполняются.
+ *
+ * @param opts Параметры (может быть NULL).
+ * @return 0 в случае успеха, -1, если mlockall() (или блокировка стека и кучи
+ *         в режиме RTMEM_SELECTIVE) не удалась (errno сохранен).
+ */
+int rtmem_init(const RtMemOptions* opts);
+
+/**
+ * @brief Блокирует в RAM одну горячую область.
+ *
+ * Границы расширяются до целых страниц. Содержимое области не меняется.
+ *
+ * @param addr Начало области.
+ * @param size Размер области в байтах.
+ * @param flags Комбинация флагов RTMEM_REGION_*.
+ * @return 0 в случае успеха, -1 в случае ошибки (errno от mlock).
+ */
+int rtmem_lock_region(void* addr, size_t size, unsigned flags);
+
+/**
+ * @brief Прогревает и блокирует стек вызывающего потока на depth байт вглубь.
+ *
+ * @param depth Глубина в байтах (для главного потока ограничивается RLIMIT_STACK).
+ * @return 0 в случае успеха, -1 в случае ошибки.
+ */
+int rtmem_lock_stack(size_t depth);
+
+/**
+ * @brief Прогревает стек вызывающего потока на depth байт вглубь.
+ *
+ * Для главного потока глубина ограничивается RLIMIT_STACK.
+ *
+ * @param depth Глубина в байтах.
+ */
+void rtmem_prefault_stack(size_t depth);
+
+#endif // RTMEM_H
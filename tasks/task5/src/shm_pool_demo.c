@@ -0,0 +1,170 @@
+/*
+ * Передача больших сообщений между процессами без копирования через ShmPool.
+ *
+ * Родитель создает пул в shared memory и порождает процесс-потребитель,
+ * который заново подключается к пулу по имени (т.е. видит сегмент по другому
+ * адресу). Производитель выделяет блок, заполняет его и передает потребителю
+ * только смещение через кольцевую очередь в пользовательской области пула.
+ * Потребитель проверяет данные прямо в разделяемом блоке и сам возвращает
+ * блок в пул — освобождение выполняется в другом процессе.
+ */
+#define _GNU_SOURCE
+#include "shmpool.h"
+#include <sched.h>
+#include <semaphore.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#define SHM_POOL_NAME "/rts_shm_pool_demo"
+#define PAYLOAD_SIZE (256 * 1024)
+#define POOL_BLOCKS 16
+#define RING_SIZE POOL_BLOCKS
+#define MESSAGES 20000
+
+// Очередь смещений в пользовательской области пула (один производитель, один потребитель)
+typedef struct {
+    sem_t slots;  // Свободные места в очереди
+    sem_t items;  // Готовые сообщения
+    size_t ring[RING_SIZE];
+    size_t head;
+    size_t tail;
+} HandoffQueue;
+
+typedef struct {
+    uint64_t seq;
+    uint64_t checksum;
+    uint8_t data[];
+} Payload;
+
+static uint64_t payload_fill(Payload* payload, size_t size, uint64_t seq) {
+    uint64_t* words = (uint64_t*)payload->data;
+    size_t count = (size - sizeof(Payload)) / sizeof(uint64_t);
+    uint64_t sum = 0;
+    for (size_t i = 0; i < count; i++) {
+        words[i] = seq * 0x9E3779B97F4A7C15ULL + i;
+        sum += words[i];
+    }
+    payload->seq = seq;
+    return sum;
+}
+
+static uint64_t payload_sum(const Payload* payload, size_t size) {
+    const uint64_t* words = (const uint64_t*)payload->data;
+    size_t count = (size - sizeof(Payload)) / sizeof(uint64_t);
+    uint64_t sum = 0;
+    for (size_t i = 0; i < count; i++) {
+        sum += words[i];
+    }
+    return sum;
+}
+
+static long long timespec_diff_ns(struct timespec start, struct timespec end) {
+    return (end.tv_sec - start.tv_sec) * 1000000000LL + (end.tv_nsec - start.tv_nsec);
+}
+
+static int consumer(ShmPool* inherited) {
+    // Подключаемся заново по имени до закрытия унаследованного отображения,
+    // чтобы сегмент гарантированно оказался по другому адресу
+    ShmPool* pool = shm_pool_open(SHM_POOL_NAME);
+    shm_pool_close(inherited);
+    if (!pool) {
+        return EXIT_FAILURE;
+    }
+    HandoffQueue* queue = shm_pool_user_area(pool);
+    size_t size = shm_pool_block_size(pool);
+    printf("Consumer: pool attached at %p\n", (void*)queue);
+
+    int errors = 0;
+    for (uint64_t expected = 0; expected < MESSAGES; expected++) {
+        sem_wait(&queue->items);
+        size_t offset = queue->ring[queue->tail];
+        queue->tail = (queue->tail + 1) % RING_SIZE;
+        sem_post(&queue->slots);
+
+        Payload* payload = shm_pool_ptr(pool, offset);
+        if (!payload || payload->seq != expected || payload_sum(payload, size) != payload->checksum) {
+            errors++;
+        }
+        shm_pool_free(pool, payload);
+    }
+    printf("Consumer: %d messages received, %d corrupted\n", MESSAGES, errors);
+    shm_pool_close(pool);
+    return errors ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+int main(void) {
+    shm_pool_unlink(SHM_POOL_NAME); // Остаток от прерванного запуска
+    ShmPool* pool = shm_pool_create(SHM_POOL_NAME, PAYLOAD_SIZE, POOL_BLOCKS, sizeof(HandoffQueue));
+    if (!pool) {
+        fprintf(stderr, "Failed to create shared memory pool\n");
+        return EXIT_FAILURE;
+    }
+    HandoffQueue* queue = shm_pool_user_area(pool);
+    sem_init(&queue->slots, 1, RING_SIZE);
+    sem_init(&queue->items, 1, 0);
+    printf("Producer: pool created at %p (%d blocks x %d KB)\n",
+           (void*)queue, POOL_BLOCKS, PAYLOAD_SIZE / 1024);
+
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid == -1) {
+        perror("fork");
+        shm_pool_close(pool);
+        shm_pool_unlink(SHM_POOL_NAME);
+        return EXIT_FAILURE;
+    }
+    if (pid == 0) {
+        int rc = consumer(pool);
+        fflush(stdout);
+        _exit(rc);
+    }
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    long long pool_empty = 0;
+    for (uint64_t seq = 0; seq < MESSAGES; seq++) {
+        Payload* payload;
+        // Блоки возвращает потребитель; пока он не успел — пул пуст
+        while (!(payload = shm_pool_alloc(pool))) {
+            pool_empty++;
+            sched_yield();
+        }
+        payload->checksum = payload_fill(payload, PAYLOAD_SIZE, seq);
+
+        sem_wait(&queue->slots);
+        queue->ring[queue->head] = shm_pool_offset(pool, payload);
+        queue->head = (queue->head + 1) % RING_SIZE;
+        sem_post(&queue->items);
+    }
+
+    int status = 0;
+    waitpid(pid, &status, 0);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    double seconds = timespec_diff_ns(start, end) / 1e9;
+    printf("Producer: %d messages x %d KB in %.3f s (%.0f msg/s, %.2f GB/s handed off by offset)\n",
+           MESSAGES, PAYLOAD_SIZE / 1024, seconds, MESSAGES / seconds,
+           (double)MESSAGES * PAYLOAD_SIZE / seconds / 1e9);
+    printf("Producer: waited for a free block %lld times\n", pool_empty);
+
+    // Все блоки должны вернуться в пул
+    size_t returned = 0;
+    void* blocks[POOL_BLOCKS];
+    while (returned < POOL_BLOCKS && (blocks[returned] = shm_pool_alloc(pool))) {
+        returned++;
+    }
+    printf("Producer: %zu of %d blocks back in the pool\n", returned, POOL_BLOCKS);
+
+    sem_destroy(&queue->slots);
+    sem_destroy(&queue->items);
+    shm_pool_close(pool);
+    shm_pool_unlink(SHM_POOL_NAME);
+
+    int ok = WIFEXITED(status) && WEXITSTATUS(status) == 0 && returned == POOL_BLOCKS;
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
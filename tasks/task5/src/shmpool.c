@@ -0,0 +1,196 @@
+#define _GNU_SOURCE
+#include "shmpool.h"
+#include "lfstack.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define CACHE_LINE_SIZE 64
+#define SHM_POOL_MAGIC 0x4c4f4f504d485352ULL // "RSHMPOOL"
+
+static size_t round_up(size_t value, size_t align) {
+    return (value + align - 1) / align * align;
+}
+
+// Заголовок в начале сегмента. Все поля, кроме головы стека, записываются
+// один раз при создании и дальше только читаются
+typedef struct {
+    _Atomic uint64_t magic;  // Публикуется последним: пул размечен
+    size_t segment_size;
+    size_t block_size;       // Запрошенный размер блока
+    size_t block_stride;     // Шаг между блоками (кратен кэш-линии)
+    size_t block_count;
+    size_t user_offset;
+    size_t user_size;
+    size_t blocks_offset;
+    // Голова lock-free стека: номер блока (1..N) + тег версии
+    _Alignas(CACHE_LINE_SIZE) LfHead head;
+} ShmPoolHeader;
+
+// Локальный для процесса дескриптор: адрес отображения у каждого свой
+struct ShmPool {
+    ShmPoolHeader* header;
+    char* base;
+    char* blocks;
+    size_t size;
+};
+
+// Ссылка свободного блока — первые 4 байта, номер следующего блока
+static _Atomic uint32_t* shm_pool_link(const void* owner, uint32_t idx) {
+    const ShmPool* pool = owner;
+    return (_Atomic uint32_t*)(pool->blocks + (size_t)(idx - 1) * pool->header->block_stride);
+}
+
+static ShmPool* shm_pool_map(int fd, size_t size) {
+    ShmPool* pool = malloc(sizeof(ShmPool));
+    if (!pool) {
+        return NULL;
+    }
+    void* base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (base == MAP_FAILED) {
+        perror("mmap");
+        free(pool);
+        return NULL;
+    }
+    // Блокировка страниц — по возможности: без CAP_IPC_LOCK лимит может не позволить
+    mlock(base, size);
+    pool->header = base;
+    pool->base = base;
+    pool->blocks = NULL;
+    pool->size = size;
+    return pool;
+}
+
+ShmPool* shm_pool_create(const char* name, size_t block_size, size_t block_count, size_t user_size) {
+    if (block_size == 0 || block_count == 0 || block_count >= UINT32_MAX) {
+        return NULL;
+    }
+
+    size_t stride = round_up(block_size < sizeof(uint32_t) ? sizeof(uint32_t) : block_size,
+                             CACHE_LINE_SIZE);
+    size_t user_offset = round_up(sizeof(ShmPoolHeader), CACHE_LINE_SIZE);
+    size_t blocks_offset = round_up(user_offset + user_size, CACHE_LINE_SIZE);
+    if (stride > (SIZE_MAX - blocks_offset) / block_count) {
+        return NULL;
+    }
+    size_t size = round_up(blocks_offset + stride * block_count, (size_t)sysconf(_SC_PAGESIZE));
+
+    int fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0666);
+    if (fd == -1) {
+        perror("shm_open");
+        return NULL;
+    }
+    if (ftruncate(fd, (off_t)size) == -1) {
+        perror("ftruncate");
+        close(fd);
+        shm_unlink(name);
+        return NULL;
+    }
+    ShmPool* pool = shm_pool_map(fd, size);
+    close(fd);
+    if (!pool) {
+        shm_unlink(name);
+        return NULL;
+    }
+
+    ShmPoolHeader* header = pool->header;
+    header->segment_size = size;
+    header->block_size = block_size;
+    header->block_stride = stride;
+    header->block_count = block_count;
+    header->user_offset = user_offset;
+    header->user_size = user_size;
+    header->blocks_offset = blocks_offset;
+    pool->blocks = pool->base + blocks_offset;
+
+    // Сегмент после ftruncate заполнен нулями; проход по всем блокам
+    // заодно выполняет предварительное касание страниц
+    for (size_t i = 1; i <= block_count; i++) {
+        atomic_store_explicit(shm_pool_link(pool, (uint32_t)i),
+                              i < block_count ? (uint32_t)(i + 1) : 0, memory_order_relaxed);
+    }
+    atomic_store_explicit(&header->head, 1, memory_order_relaxed);
+    atomic_store_explicit(&header->magic, SHM_POOL_MAGIC, memory_order_release);
+    return pool;
+}
+
+ShmPool* shm_pool_open(const char* name) {
+    int fd = shm_open(name, O_RDWR, 0);
+    if (fd == -1) {
+        perror("shm_open");
+        return NULL;
+    }
+    struct stat st;
+    if (fstat(fd, &st) == -1 || (size_t)st.st_size < sizeof(ShmPoolHeader)) {
+        close(fd);
+        return NULL;
+    }
+    ShmPool* pool = shm_pool_map(fd, (size_t)st.st_size);
+    close(fd);
+    if (!pool) {
+        return NULL;
+    }
+
+    ShmPoolHeader* header = pool->header;
+    if (atomic_load_explicit(&header->magic, memory_order_acquire) != SHM_POOL_MAGIC ||
+        header->segment_size != pool->size) {
+        // Сегмент еще не размечен создателем или не является пулом
+        fprintf(stderr, "shm_pool_open: %s is not an initialized pool\n", name);
+        shm_pool_close(pool);
+        errno = EINVAL;
+        return NULL;
+    }
+    pool->blocks = pool->base + header->blocks_offset;
+    return pool;
+}
+
+void* shm_pool_alloc(ShmPool* pool) {
+    uint32_t idx = lfstack_pop(&pool->header->head, shm_pool_link, pool);
+    return idx ? (void*)shm_pool_link(pool, idx) : NULL;
+}
+
+void shm_pool_free(ShmPool* pool, void* block) {
+    if (!block) {
+        return;
+    }
+    size_t idx = (size_t)((char*)block - pool->blocks) / pool->header->block_stride + 1;
+    lfstack_push(&pool->header->head, shm_pool_link(pool, (uint32_t)idx), (uint32_t)idx);
+}
+
+size_t shm_pool_offset(const ShmPool* pool, const void* block) {
+    return (size_t)((const char*)block - pool->base);
+}
+
+void* shm_pool_ptr(const ShmPool* pool, size_t offset) {
+    const ShmPoolHeader* header = pool->header;
+    if (offset < header->blocks_offset || offset >= pool->size) {
+        return NULL;
+    }
+    return pool->base + offset;
+}
+
+void* shm_pool_user_area(ShmPool* pool) {
+    return pool->header->user_size ? pool->base + pool->header->user_offset : NULL;
+}
+
+size_t shm_pool_block_size(const ShmPool* pool) {
+    return pool->header->block_size;
+}
+
+void shm_pool_close(ShmPool* pool) {
+    if (!pool) {
+        return;
+    }
+    munmap(pool->base, pool->size);
+    free(pool);
+}
+
+int shm_pool_unlink(const char* name) {
+    return shm_unlink(name);
+}
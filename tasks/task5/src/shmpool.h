@@ -0,0 +1,107 @@
+#ifndef SHMPOOL_H
+#define SHMPOOL_H
+
+#include <stddef.h>
+
+/*
+ * Пул блоков фиксированного размера внутри сегмента POSIX shared memory.
+ *
+ * Сегмент содержит заголовок пула, пользовательскую область (например, для
+ * очереди смещений) и сами блоки. Связи списка свободных блоков хранятся как
+ * номера блоков, а не указатели, поэтому пул работает в любом процессе,
+ * подключившем сегмент, независимо от адреса отображения. Выделение и
+ * освобождение lock-free (тот же стек с тегом версии, что и в POOL_CONCURRENT),
+ * так что процесс, завершившийся посреди операции, не оставляет захваченных
+ * блокировок. Между процессами блоки передаются смещением (shm_pool_offset /
+ * shm_pool_ptr) без копирования данных.
+ */
+
+typedef struct ShmPool ShmPool;
+
+/**
+ * @brief Создает сегмент и размечает в нем пул.
+ *
+ * @param name Имя объекта shared memory (начинается с '/').
+ * @param block_size Размер одного блока в байтах.
+ * @param block_count Количество блоков.
+ * @param user_size Размер пользовательской области в сегменте (может быть 0).
+ * @return Дескриптор пула или NULL в случае ошибки (в т.ч. если сегмент уже есть).
+ */
+ShmPool* shm_pool_create(const char* name, size_t block_size, size_t block_count, size_t user_size);
+
+/**
+ * @brief Подключается к существующему пулу.
+ *
+ * @param name Имя объекта shared memory.
+ * @return Дескриптор пула или NULL в случае ошибки.
+ */
+ShmPool* shm_pool_open(const char* name);
+
+/**
+ * @brief Выделяет блок (lock-free, безопасно из нескольких процессов).
+ *
+ * @param pool Дескриптор пула.
+ * @return Указатель на блок в адресном пространстве текущего процесса или NULL.
+ */
+void* shm_pool_alloc(ShmPool* pool);
+
+/**
+ * @brief Возвращает блок в пул (из любого подключенного процесса).
+ *
+ * @param pool Дескриптор пула.
+ * @param block Указатель на блок в адресном пространстве текущего процесса.
+ */
+void shm_pool_free(ShmPool* pool, void* block);
+
+/**
+ * @brief Переводит указатель на блок в смещение от начала сегмента.
+ *
+ * @param pool Дескриптор пула.
+ * @param block Указатель на блок.
+ * @return Смещение, пригодное для передачи другому процессу.
+ */
+size_t shm_pool_offset(const ShmPool* pool, const void* block);
+
+/**
+ * @brief Переводит смещение, полученное от другого процесса, в указатель.
+ *
+ * @param pool Дескриптор пула.
+ * @param offset Смещение от начала сегмента.
+ * @return Указатель на блок или NULL, если смещение вне области блоков.
+ */
+void* shm_pool_ptr(const ShmPool* pool, size_t offset);
+
+/**
+ * @brief Возвращает пользовательскую область сегмента.
+ *
+ * Область выровнена по кэш-линии и обнулена при создании пула.
+ *
+ * @param pool Дескриптор пула.
+ * @return Указатель на область (NULL, если user_size был 0).
+ */
+void* shm_pool_user_area(ShmPool* pool);
+
+/**
+ * @brief Возвращает размер блока пула.
+ *
+ * @param pool Дескриптор пула.
+ * @return Размер блока в байтах.
+ */
+size_t shm_pool_block_size(const ShmPool* pool);
+
+/**
+ * @brief Отключает текущий процесс от пула (сегмент остается).
+ *
+ * @param pool Дескриптор пула.
+ */
+void shm_pool_close(ShmPool* pool);
+
+/**
+ * @brief Удаляет имя сегмента (память освобождается после отключения всех процессов).
+ *
+ * @param name Имя объекта shared memory.
+ * @return 0 при успехе, -1 при ошибке.
+ */
+int shm_pool_unlink(const char* name);
+
+#endif // SHMPOOL_H
@@ -0,0 +1,103 @@
+#include "slab.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+struct SlabAllocator {
+    size_t class_count;
+    size_t max_size;
+    int concurrent;
+    size_t block_size[SLAB_MAX_CLASSES];
+    MemoryPool* pools[SLAB_MAX_CLASSES];
+    uint8_t* size_to_class; // Номер класса для каждого шага SLAB_GRANULE
+};
+
+static int compare_class(const void* a, const void* b) {
+    size_t sa = ((const SlabClass*)a)->block_size;
+    size_t sb = ((const SlabClass*)b)->block_size;
+    return (sa > sb) - (sa < sb);
+}
+
+SlabAllocator* slab_create(const SlabClass* classes, size_t class_count, const PoolOptions* opts) {
+    if (!classes || class_count == 0 || class_count > SLAB_MAX_CLASSES) {
+        return NULL;
+    }
+
+    SlabAllocator* slab = (SlabAllocator*)calloc(1, sizeof(SlabAllocator));
+    if (!slab) return NULL;
+
+    // Классы упорядочиваются по размеру, чтобы при исчерпании брать следующий
+    SlabClass sorted[SLAB_MAX_CLASSES];
+    memcpy(sorted, classes, class_count * sizeof(SlabClass));
+    qsort(sorted, class_count, sizeof(SlabClass), compare_class);
+
+    slab->class_count = class_count;
+    slab->max_size = sorted[class_count - 1].block_size;
+    slab->concurrent = opts && (opts->flags & POOL_CONCURRENT);
+    for (size_t i = 0; i < class_count; ++i) {
+        slab->block_size[i] = sorted[i].block_size;
+        slab->pools[i] = pool_create_ex(sorted[i].block_size, sorted[i].block_count, opts);
+        if (!slab->pools[i]) {
+            slab_destroy(slab);
+            return NULL;
+        }
+    }
+
+    // Таблица: размер, округленный вверх до SLAB_GRANULE -> наименьший подходящий класс
+    size_t entries = (slab->max_size + SLAB_GRANULE - 1) / SLAB_GRANULE + 1;
+    slab->size_to_class = (uint8_t*)malloc(entries);
+    if (!slab->size_to_class) {
+        slab_destroy(slab);
+        return NULL;
+    }
+    size_t cls = 0;
+    for (size_t e = 0; e < entries; ++e) {
+        while (cls < class_count && slab->block_size[cls] < e * SLAB_GRANULE) {
+            ++cls;
+        }
+        // Последняя ячейка может покрывать размеры больше максимального класса,
+        // такие запросы отсекаются в slab_alloc по max_size
+        slab->size_to_class[e] = (uint8_t)(cls < class_count ? cls : class_count - 1);
+    }
+
+    return slab;
+}
+
+void* slab_alloc(SlabAllocator* slab, size_t size) {
+    if (!slab || size > slab->max_size) {
+        return NULL;
+    }
+
+    for (size_t cls = slab->size_to_class[(size + SLAB_GRANULE - 1) / SLAB_GRANULE];
+         cls < slab->class_count; ++cls) {
+        void* block = slab->concurrent ? pool_alloc_mt(slab->pools[cls])
+                                       : pool_alloc(slab->pools[cls]);
+        if (block) return block;
+    }
+    return NULL;
+}
+
+void slab_free(SlabAllocator* slab, void* block) {
+    if (!slab || !block) return;
+
+    // Перебор ограничен SLAB_MAX_CLASSES сравнениями диапазонов
+    for (size_t cls = 0; cls < slab->class_count; ++cls) {
+        if (pool_owns(slab->pools[cls], block)) {
+            if (slab->concurrent) {
+                pool_free_mt(slab->pools[cls], block);
+            } else {
+                pool_free(slab->pools[cls], block);
+            }
+            return;
+        }
+    }
+}
+
+void slab_destroy(SlabAllocator* slab) {
+    if (!slab) return;
+    for (size_t i = 0; i < slab->class_count; ++i) {
+        pool_destroy(slab->pools[i]);
+    }
+    free(slab->size_to_class);
+    free(slab);
+}
@@ -0,0 +1,65 @@
+#ifndef SLAB_H
+#define SLAB_H
+
+#include <stddef.h>
+#include "mempool.h"
+
+/*
+ * Slab-аллокатор: набор классов размеров, каждый из которых обслуживается
+ * собственным MemoryPool. Класс для запрошенного размера находится за O(1)
+ * по таблице, а при освобождении определяется по адресу блока, поэтому
+ * размер передавать не нужно.
+ */
+
+#define SLAB_MAX_CLASSES 16
+#define SLAB_GRANULE 16 // Шаг таблицы поиска класса по размеру, байт
+
+typedef struct SlabAllocator SlabAllocator;
+
+/**
+ * @brief Описание одного класса размеров.
+ */
+typedef struct {
+    size_t block_size;  ///< Размер блока класса в байтах.
+    size_t block_count; ///< Количество блоков в классе.
+} SlabClass;
+
+/**
+ * @brief Создает slab-аллокатор.
+ *
+ * @param classes Классы размеров (в любом порядке, не более SLAB_MAX_CLASSES).
+ * @param class_count Количество классов.
+ * @param opts Параметры, применяемые к пулу каждого класса (может быть NULL).
+ *             С флагом POOL_CONCURRENT аллокатор потокобезопасен.
+ * @return Указатель на аллокатор или NULL в случае ошибки.
+ */
+SlabAllocator* slab_create(const SlabClass* classes, size_t class_count, const PoolOptions* opts);
+
+/**
+ * @brief Выделяет блок не меньше size байт.
+ *
+ * Если подходящий класс исчерпан, блок берется из следующего большего класса.
+ *
+ * @param slab Указатель на аллокатор.
+ * @param size Требуемый размер в байтах.
+ * @return Указатель на блок или NULL, если size больше максимального класса
+ *         или все подходящие классы исчерпаны.
+ */
+void* slab_alloc(SlabAllocator* slab, size_t size);
+
+/**
+ * @brief Возвращает блок в его класс (размер определяется по адресу).
+ *
+ * @param slab Указатель на аллокатор.
+ * @param block Указатель на блок.
+ */
+void slab_free(SlabAllocator* slab, void* block);
+
+/**
+ * @brief Уничтожает аллокатор и пулы всех классов.
+ *
+ * @param slab Указатель на аллокатор.
+ */
+void slab_destroy(SlabAllocator* slab);
+
+#endif // SLAB_H
@@ -1,60 +1,348 @@
-#define _POSIX_C_SOURCE 200809L
+#define _GNU_SOURCE
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
 #include <unistd.h>
 #include <time.h>
+#include <sys/mman.h>
 #include <sys/resource.h>
-
+#include "faultcount.h"
+#include "uffdpop.h"
 
 #define ARRAY_SIZE (512 * 1024 * 1024) // 512 MB
 #define PAGE_SIZE 4096
 #define NUM_ITERATIONS 1000
+#define HUGE_PAGE_SIZE (2 * 1024 * 1024)
+#define HIST_BUCKETS 32      // Корзины задержки: [2^k, 2^(k+1)) нс
+#define COST_ITERATIONS 1000 // Замеров стоимости чтения счетчика
+#define UFFD_WINDOW_KB 2048  // Окно заполнения userfaultfd по умолчанию
+
+typedef enum { ALLOC_MALLOC, ALLOC_MMAP, ALLOC_POPULATE, ALLOC_THP, ALLOC_UFFD } AllocMode;
+
+static const char* const alloc_names[] = {"malloc", "mmap", "populate", "thp", "uffd"};
+
+// Результат одного обращения к массиву
+typedef struct {
+    long long latency_ns;
+    uint32_t minor;
+    uint32_t major;
+} Access;
+
+// Обращения одного класса: без отказа, с minor fault, с major fault
+typedef struct {
+    const char* name;
+    long long* latencies;
+    size_t count;
+    uint64_t faults;
+    uint64_t hist[HIST_BUCKETS];
+} AccessClass;
 
 long long timespec_diff_ns(struct timespec start, struct timespec end) {
     return (end.tv_sec - start.tv_sec) * 1000000000LL + (end.tv_nsec - start.tv_nsec);
 }
 
-int main() {
-    printf("Task 1: Demonstrating Page Faults\n");
+static int hist_bucket(long long ns) {
+    int bucket = 0;
+    while (ns > 1 && bucket < HIST_BUCKETS - 1) {
+        ns >>= 1;
+        bucket++;
+    }
+    return bucket;
+}
 
-    // Выделить большой массив с помощью malloc
-    char *array = (char *)malloc(ARRAY_SIZE);
-    if (!array) {
+static int compare_ll(const void* a, const void* b) {
+    long long x = *(const long long*)a;
+    long long y = *(const long long*)b;
+    return (x > y) - (x < y);
+}
+
+static long long percentile(const long long* sorted, size_t count, double p) {
+    size_t idx = (size_t)(p / 100.0 * (double)count);
+    if (idx >= count) idx = count - 1;
+    return sorted[idx];
+}
+
+// Выделяет массив выбранным способом; *mapped != 0 — освобождать через munmap,
+// *uffd != NULL — через uffd_region_destroy()
+static char* alloc_array(AllocMode mode, size_t size, size_t window, size_t* mapped, UffdRegion** uffd) {
+    *mapped = 0;
+    *uffd = NULL;
+    switch (mode) {
+    case ALLOC_MALLOC:
+        return (char*)malloc(size);
+    case ALLOC_MMAP:
+    case ALLOC_POPULATE: {
+        int flags = MAP_PRIVATE | MAP_ANONYMOUS | (mode == ALLOC_POPULATE ? MAP_POPULATE : 0);
+        char* p = mmap(NULL, size, PROT_READ | PROT_WRITE, flags, -1, 0);
+        if (p == MAP_FAILED) return NULL;
+        *mapped = size;
+        return p;
+    }
+    case ALLOC_THP: {
+        // Запас на выравнивание начала по 2 МБ, иначе первая huge page не поместится
+        size_t len = size + HUGE_PAGE_SIZE;
+        char* p = mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (p == MAP_FAILED) return NULL;
+        char* aligned = (char*)(((uintptr_t)p + HUGE_PAGE_SIZE - 1) & ~(uintptr_t)(HUGE_PAGE_SIZE - 1));
+        if (aligned > p) munmap(p, (size_t)(aligned - p));
+        size_t tail = (size_t)(p + len - (aligned + size));
+        if (tail) munmap(aligned + size, tail);
+        if (madvise(aligned, size, MADV_HUGEPAGE) != 0) {
+            perror("madvise(MADV_HUGEPAGE)");
+        }
+        *mapped = size;
+        return aligned;
+    }
+    case ALLOC_UFFD:
+        *uffd = uffd_region_create(size, window, 0);
+        return *uffd ? (char*)uffd_region_base(*uffd) : NULL;
+    }
+    return NULL;
+}
+
+// Медианная стоимость пары чтений счетчика (до и после обращения)
+static long long counter_read_cost(FaultCounter* fc) {
+    static long long samples[COST_ITERATIONS];
+    struct timespec start_time, end_time;
+    uint64_t minor, major;
+    for (int i = 0; i < COST_ITERATIONS; ++i) {
+        clock_gettime(CLOCK_MONOTONIC, &start_time);
+        faultcount_read(fc, &minor, &major);
+        faultcount_read(fc, &minor, &major);
+        clock_gettime(CLOCK_MONOTONIC, &end_time);
+        samples[i] = timespec_diff_ns(start_time, end_time);
+    }
+    qsort(samples, COST_ITERATIONS, sizeof(samples[0]), compare_ll);
+    return samples[COST_ITERATIONS / 2];
+}
+
+static long long getrusage_cost(void) {
+    static long long samples[COST_ITERATIONS];
+    struct timespec start_time, end_time;
+    struct rusage usage;
+    for (int i = 0; i < COST_ITERATIONS; ++i) {
+        clock_gettime(CLOCK_MONOTONIC, &start_time);
+        getrusage(RUSAGE_SELF, &usage);
+        getrusage(RUSAGE_SELF, &usage);
+        clock_gettime(CLOCK_MONOTONIC, &end_time);
+        samples[i] = timespec_diff_ns(start_time, end_time);
+    }
+    qsort(samples, COST_ITERATIONS, sizeof(samples[0]), compare_ll);
+    return samples[COST_ITERATIONS / 2];
+}
+
+static void print_classes(AccessClass* classes, int count) {
+    printf("\n%-10s %10s %10s %10s %10s %10s %10s\n",
+           "Class", "Accesses", "Faults", "Min (ns)", "p50 (ns)", "p99 (ns)", "Max (ns)");
+    for (int c = 0; c < count; ++c) {
+        AccessClass* cls = &classes[c];
+        if (cls->count == 0) {
+            printf("%-10s %10zu %10s %10s %10s %10s %10s\n", cls->name, cls->count, "-", "-", "-", "-", "-");
+            continue;
+        }
+        qsort(cls->latencies, cls->count, sizeof(long long), compare_ll);
+        printf("%-10s %10zu %10llu %10lld %10lld %10lld %10lld\n", cls->name, cls->count,
+               (unsigned long long)cls->faults, cls->latencies[0],
+               percentile(cls->latencies, cls->count, 50.0),
+               percentile(cls->latencies, cls->count, 99.0),
+               cls->latencies[cls->count - 1]);
+    }
+}
+
+static void print_histogram(AccessClass* classes, int count) {
+    int first = HIST_BUCKETS, last = -1;
+    for (int c = 0; c < count; ++c) {
+        for (int b = 0; b < HIST_BUCKETS; ++b) {
+            if (classes[c].hist[b] == 0) continue;
+            if (b < first) first = b;
+            if (b > last) last = b;
+        }
+    }
+    if (last < 0) return;
+
+    printf("\nLatency histogram (ns)\n%-22s", "Bucket");
+    for (int c = 0; c < count; ++c) printf(" %10s", classes[c].name);
+    printf("\n");
+    for (int b = first; b <= last; ++b) {
+        char range[32];
+        snprintf(range, sizeof(range), "[%lld, %lld)", 1LL << b, 1LL << (b + 1));
+        printf("%-22s", range);
+        for (int c = 0; c < count; ++c) printf(" %10llu", (unsigned long long)classes[c].hist[b]);
+        printf("\n");
+    }
+}
+
+static void usage(const char* prog) {
+    fprintf(stderr,
+            "Usage: %s [-m malloc|mmap|populate|thp|uffd] [-s stride] [-n iterations] [-S size_mb]\n"
+            "          [-w window_kb] [-c ring|read|rusage] [-v]\n"
+            "  -m  способ выделения массива (по умолчанию malloc); uffd — промахи обслуживает\n"
+            "      поток userfaultfd, заполняя окно вперед от страницы промаха\n"
+            "  -w  окно заполнения для -m uffd в КБ (по умолчанию %d)\n"
+            "  -s  шаг обращений в байтах (по умолчанию %d)\n"
+            "  -n  число обращений (по умолчанию %d)\n"
+            "  -S  размер массива в МБ (по умолчанию %d)\n"
+            "  -c  способ чтения счетчиков отказов (по умолчанию ring, при недоступности — следующий)\n"
+            "  -v  вывести каждое обращение: итерация, задержка, minor и major faults\n",
+            prog, UFFD_WINDOW_KB, PAGE_SIZE, NUM_ITERATIONS, ARRAY_SIZE / (1024 * 1024));
+}
+
+int main(int argc, char** argv) {
+    AllocMode mode = ALLOC_MALLOC;
+    FaultCountMethod method = FAULTCOUNT_RING;
+    size_t stride = PAGE_SIZE;
+    size_t array_size = ARRAY_SIZE;
+    size_t window = UFFD_WINDOW_KB * 1024;
+    int iterations = NUM_ITERATIONS;
+    int verbose = 0;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "m:s:n:S:w:c:v")) != -1) {
+        switch (opt) {
+        case 'm':
+            if (strcmp(optarg, "malloc") == 0) mode = ALLOC_MALLOC;
+            else if (strcmp(optarg, "mmap") == 0) mode = ALLOC_MMAP;
+            else if (strcmp(optarg, "populate") == 0) mode = ALLOC_POPULATE;
+            else if (strcmp(optarg, "thp") == 0) mode = ALLOC_THP;
+            else if (strcmp(optarg, "uffd") == 0) mode = ALLOC_UFFD;
+            else {
+                usage(argv[0]);
+                return 1;
+            }
+            break;
+        case 's':
+            stride = (size_t)strtoull(optarg, NULL, 0);
+            break;
+        case 'n':
+            iterations = atoi(optarg);
+            break;
+        case 'S':
+            array_size = (size_t)strtoull(optarg, NULL, 0) * 1024 * 1024;
+            break;
+        case 'w':
+            window = (size_t)strtoull(optarg, NULL, 0) * 1024;
+            break;
+        case 'c':
+            if (strcmp(optarg, "ring") == 0) method = FAULTCOUNT_RING;
+            else if (strcmp(optarg, "read") == 0) method = FAULTCOUNT_READ;
+            else if (strcmp(optarg, "rusage") == 0) method = FAULTCOUNT_RUSAGE;
+            else {
+                usage(argv[0]);
+                return 1;
+            }
+            break;
+        case 'v':
+            verbose = 1;
+            break;
+        default:
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (stride == 0 || iterations <= 0 || array_size == 0) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    printf("Task 1: Page fault profiler\n");
+
+    FaultCounter* fc = faultcount_create(method);
+    if (!fc) {
+        perror("faultcount_create failed");
+        return 1;
+    }
+
+    // Журнал обращений выделяется и прогревается заранее, чтобы его собственные
+    // отказы не попали в измерения
+    Access* log = (Access*)malloc((size_t)iterations * sizeof(Access));
+    long long* latencies = (long long*)malloc((size_t)iterations * sizeof(long long));
+    if (!log || !latencies) {
         perror("malloc failed");
         return 1;
     }
+    memset(log, 0, (size_t)iterations * sizeof(Access));
+    memset(latencies, 0, (size_t)iterations * sizeof(long long));
 
     struct timespec start_time, end_time;
-    struct rusage usage_before, usage_after;
+    clock_gettime(CLOCK_MONOTONIC, &start_time);
+    size_t mapped;
+    UffdRegion* uffd;
+    char* array = alloc_array(mode, array_size, window, &mapped, &uffd);
+    clock_gettime(CLOCK_MONOTONIC, &end_time);
+    if (!array) {
+        perror("array allocation failed");
+        return 1;
+    }
 
-    printf("Iter\tLatency (ns)\tMinor Faults\tMajor Faults\n");
+    printf("Mode: %s, array %zu MB, stride %zu B, %d accesses\n",
+           alloc_names[mode], array_size / (1024 * 1024), stride, iterations);
+    if (uffd) printf("userfaultfd window: %zu KB\n", window / 1024);
+    printf("Allocation time: %.3f ms\n", timespec_diff_ns(start_time, end_time) / 1e6);
+    printf("Fault counter: %s, read cost %lld ns per access (getrusage: %lld ns)\n",
+           faultcount_method_name(faultcount_method(fc)), counter_read_cost(fc), getrusage_cost());
 
-    for (int i = 0; i < NUM_ITERATIONS; ++i) {
-        // Получить статистику использования ресурсов ДО доступа к памяти (getrusage)
-        getrusage(RUSAGE_SELF, &usage_before);
+    uint64_t minor_before, major_before, minor_after, major_after;
+    faultcount_read(fc, &minor_before, &major_before);
+    for (int i = 0; i < iterations; ++i) {
+        size_t index = ((size_t)i * stride) % array_size;
 
-        // Замерить время ДО доступа
         clock_gettime(CLOCK_MONOTONIC, &start_time);
-
-        // Обратиться к элементу массива с шагом, равным размеру страницы
-        // Это спровоцирует page fault, если страница еще не в памяти
-        int index = (i * PAGE_SIZE) % ARRAY_SIZE;
         array[index] = 1;
-
-        // Замерить время ПОСЛЕ доступа
         clock_gettime(CLOCK_MONOTONIC, &end_time);
 
-        // Получить статистику использования ресурсов ПОСЛЕ доступа
-        getrusage(RUSAGE_SELF, &usage_after);
+        // Счетчики читаются вне замеряемого интервала
+        faultcount_read(fc, &minor_after, &major_after);
+        log[i].latency_ns = timespec_diff_ns(start_time, end_time);
+        log[i].minor = (uint32_t)(minor_after - minor_before);
+        log[i].major = (uint32_t)(major_after - major_before);
+        minor_before = minor_after;
+        major_before = major_after;
+    }
 
-        long long latency = timespec_diff_ns(start_time, end_time);
-        long minor_faults = usage_after.ru_minflt - usage_before.ru_minflt;
-        long major_faults = usage_after.ru_majflt - usage_before.ru_majflt;
+    if (verbose) {
+        printf("\nIter\tLatency (ns)\tMinor Faults\tMajor Faults\n");
+        for (int i = 0; i < iterations; ++i) {
+            printf("%d\t%lld\t\t%u\t\t%u\n", i, log[i].latency_ns, log[i].minor, log[i].major);
+        }
+    }
 
-        printf("%d\t%lld\t\t%ld\t\t%ld\n", i, latency, minor_faults, major_faults);
+    // Разложить обращения по классам; у каждого класса свой участок latencies
+    AccessClass classes[3] = {{.name = "no-fault"}, {.name = "minor"}, {.name = "major"}};
+    size_t class_count[3] = {0, 0, 0};
+    for (int i = 0; i < iterations; ++i) {
+        class_count[log[i].major ? 2 : (log[i].minor ? 1 : 0)]++;
     }
+    classes[0].latencies = latencies;
+    classes[1].latencies = latencies + class_count[0];
+    classes[2].latencies = latencies + class_count[0] + class_count[1];
+    for (int i = 0; i < iterations; ++i) {
+        AccessClass* cls = &classes[log[i].major ? 2 : (log[i].minor ? 1 : 0)];
+        cls->latencies[cls->count++] = log[i].latency_ns;
+        cls->faults += log[i].minor + log[i].major;
+        cls->hist[hist_bucket(log[i].latency_ns)]++;
+    }
+
+    print_classes(classes, 3);
+    print_histogram(classes, 3);
 
-    free(array);
+    if (uffd) {
+        UffdStats stats;
+        uffd_region_stats(uffd, &stats);
+        printf("\nuserfaultfd handler: %llu misses served, %llu pages populated, max wake %llu ns\n",
+               stats.faults, stats.pages, stats.max_wake_ns);
+        if (stats.errors) {
+            printf("userfaultfd handler stopped after a failed fill; later faults served by the kernel\n");
+        }
+        uffd_region_destroy(uffd);
+    } else if (mapped) {
+        munmap(array, mapped);
+    } else {
+        free(array);
+    }
+    free(latencies);
+    free(log);
+    faultcount_destroy(fc);
     return 0;
 }
@@ -1,21 +1,274 @@
-#define _POSIX_C_SOURCE 200809L
+#define _GNU_SOURCE
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
 #include <unistd.h>
 #include <time.h>
 #include <sys/resource.h>
 #include <sys/mman.h>
+#include <sys/wait.h>
+#include "faultcount.h"
+#include "memaudit.h"
+#include "prefault.h"
+#include "rtmem.h"
 
 #define ARRAY_SIZE (512 * 1024 * 1024) // 512 MB
 #define PAGE_SIZE 4096
 #define NUM_ITERATIONS 1000
+#define PREFAULT_METHODS 4
+
+// Сценарий сравнения mlockall и выборочной блокировки
+#define HOT_POOL_SIZE (64 * 1024 * 1024)   // Пул блоков RT-пути
+#define HOT_RING_SIZE (4 * 1024 * 1024)    // Кольцевой буфер сообщений
+#define RING_SLOT_SIZE 64
+#define COLD_BUFFER_SIZE (256 * 1024 * 1024) // Буфер инициализации, из которого используется начало
+#define COLD_USED_SIZE (1024 * 1024)
+#define COLD_TABLE_SIZE (32 * 1024 * 1024)   // Таблица в .bss, которую RT-путь не трогает
+#define RT_STACK_FRAME (32 * 1024)
+#define RT_ITERATIONS 200000
 
 long long timespec_diff_ns(struct timespec start, struct timespec end) {
     return (end.tv_sec - start.tv_sec) * 1000000000LL + (end.tv_nsec - start.tv_nsec);
 }
 
-int main() {
+// Значение поля /proc/self/status (VmRSS, VmHWM) в КБ или -1
+static long status_kb(const char* key) {
+    FILE* f = fopen("/proc/self/status", "r");
+    if (!f) return -1;
+    char line[256];
+    size_t len = strlen(key);
+    long value = -1;
+    while (fgets(line, sizeof(line), f)) {
+        if (strncmp(line, key, len) == 0 && line[len] == ':') {
+            value = atol(line + len + 1);
+            break;
+        }
+    }
+    fclose(f);
+    return value;
+}
+
+// Сравнение способов prefault: время до готовности области, пиковый RSS
+// и число отказов при последующем проходе по всем страницам
+static int benchmark_prefault(size_t size, int threads) {
+    static const PrefaultMethod methods[PREFAULT_METHODS] = {
+        PREFAULT_TOUCH, PREFAULT_MAP_POPULATE, PREFAULT_MADVISE, PREFAULT_PARALLEL};
+
+    FaultCounter* fc = faultcount_create(FAULTCOUNT_RING);
+    if (!fc) {
+        perror("faultcount_create failed");
+        return 1;
+    }
+
+    printf("Prefault strategies: %zu MB, parallel threads %d (0 = all CPUs), fault counter: %s\n",
+           size / (1024 * 1024), threads, faultcount_method_name(faultcount_method(fc)));
+    printf("%-20s %12s %14s %14s %12s\n", "Strategy", "Ready (ms)", "Peak RSS (MB)", "Steady faults", "Pass (ms)");
+
+    double best_ms = 0.0;
+    PrefaultMethod best = PREFAULT_TOUCH;
+    for (int m = 0; m < PREFAULT_METHODS; ++m) {
+        // Сбросить VmHWM до текущего RSS (ядро 4.0+), чтобы пик относился к этому прогону
+        FILE* clear = fopen("/proc/self/clear_refs", "w");
+        if (clear) {
+            fputs("5", clear);
+            fclose(clear);
+        }
+        long rss_before = status_kb("VmRSS");
+
+        struct timespec start_time, end_time;
+        clock_gettime(CLOCK_MONOTONIC, &start_time);
+        char* array = (char*)prefault_map(size, methods[m], threads);
+        clock_gettime(CLOCK_MONOTONIC, &end_time);
+        if (!array) {
+            printf("%-20s %12s\n", prefault_method_name(methods[m]), "failed");
+            continue;
+        }
+        double ready_ms = timespec_diff_ns(start_time, end_time) / 1e6;
+        long peak_kb = status_kb("VmHWM") - rss_before;
+
+        // Установившийся режим: запись в каждую страницу не должна вызывать отказов
+        uint64_t minor_before, major_before, minor_after, major_after;
+        faultcount_read(fc, &minor_before, &major_before);
+        clock_gettime(CLOCK_MONOTONIC, &start_time);
+        for (size_t i = 0; i < size; i += PAGE_SIZE) {
+            array[i] = 1;
+        }
+        clock_gettime(CLOCK_MONOTONIC, &end_time);
+        faultcount_read(fc, &minor_after, &major_after);
+        double pass_ms = timespec_diff_ns(start_time, end_time) / 1e6;
+
+        printf("%-20s %12.1f %14.1f %14llu %12.1f\n", prefault_method_name(methods[m]), ready_ms,
+               peak_kb / 1024.0, (unsigned long long)(minor_after - minor_before + major_after - major_before),
+               pass_ms);
+        if (m == 0 || ready_ms < best_ms) {
+            best_ms = ready_ms;
+            best = methods[m];
+        }
+        munmap(array, size);
+    }
+
+    printf("Fastest: %s (prefault_alloc() picks MADV_POPULATE_WRITE or parallel by region size)\n",
+           prefault_method_name(best));
+    faultcount_destroy(fc);
+    return 0;
+}
+
+// Холодные данные: RT-путь их не трогает, но mlockall заполняет и блокирует их целиком
+char cold_table[COLD_TABLE_SIZE];
+
+static uint32_t xorshift32(uint32_t* state) {
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *state = x;
+}
+
+// Кадр обработчика RT-цикла с локальным буфером на стеке
+static void __attribute__((noinline)) rt_handler(char* pool, char* ring, size_t slot, uint32_t* rng) {
+    char frame[RT_STACK_FRAME];
+    volatile char* local = frame;
+    local[xorshift32(rng) % RT_STACK_FRAME] = 1;
+    pool[(size_t)xorshift32(rng) % HOT_POOL_SIZE] = 1;
+    memset(ring + slot * RING_SLOT_SIZE, (int)slot, RING_SLOT_SIZE);
+}
+
+// Один прогон в отдельном процессе: mlockall необратимо меняет все будущие отображения
+static void run_locking(int selective) {
+    struct timespec start_time, end_time;
+    clock_gettime(CLOCK_MONOTONIC, &start_time);
+
+    RtMemOptions opts = { .flags = selective ? RTMEM_SELECTIVE : 0 };
+    if (rtmem_init(&opts) != 0) {
+        perror("rtmem_init failed. Try running with sudo.");
+        exit(1);
+    }
+
+    // Одноразовый буфер инициализации: используется только его начало
+    char* cold = (char*)malloc(COLD_BUFFER_SIZE);
+    char* pool = mmap(NULL, HOT_POOL_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    char* ring = mmap(NULL, HOT_RING_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (!cold || pool == MAP_FAILED || ring == MAP_FAILED) {
+        perror("allocation failed");
+        exit(1);
+    }
+    memset(cold, 1, COLD_USED_SIZE);
+
+    if (selective) {
+        // Пул заполняется и блокируется целиком; кольцо блокируется по касанию,
+        // а касается его инициализация слотов
+        if (rtmem_lock_region(pool, HOT_POOL_SIZE, RTMEM_REGION_PREFAULT) != 0 ||
+            rtmem_lock_region(ring, HOT_RING_SIZE, 0) != 0) {
+            perror("rtmem_lock_region failed");
+            exit(1);
+        }
+    }
+    memset(ring, 0, HOT_RING_SIZE);
+    clock_gettime(CLOCK_MONOTONIC, &end_time);
+    double setup_ms = timespec_diff_ns(start_time, end_time) / 1e6;
+
+    FaultCounter* fc = faultcount_create(FAULTCOUNT_RING);
+    if (!fc) {
+        perror("faultcount_create failed");
+        exit(1);
+    }
+    uint32_t rng = 2463534242u;
+    uint64_t minor_before, major_before, minor_after, major_after;
+    faultcount_read(fc, &minor_before, &major_before);
+    for (int i = 0; i < RT_ITERATIONS; ++i) {
+        rt_handler(pool, ring, (size_t)i % (HOT_RING_SIZE / RING_SLOT_SIZE), &rng);
+    }
+    faultcount_read(fc, &minor_after, &major_after);
+
+    printf("%-12s %10.1f %10.1f %12.1f %10llu\n", selective ? "selective" : "mlockall",
+           status_kb("VmRSS") / 1024.0, status_kb("VmLck") / 1024.0, setup_ms,
+           (unsigned long long)(minor_after - minor_before + major_after - major_before));
+    fflush(stdout);
+    faultcount_destroy(fc);
+}
+
+// Сравнение mlockall с блокировкой только горячих областей: RSS и отказы RT-пути
+static int benchmark_locking(void) {
+    printf("Locking: mlockall vs selective (hot pool %d MB, ring %d MB, stack %d KB;\n"
+           "cold: %d MB init buffer with %d MB used, %d MB .bss table)\n",
+           HOT_POOL_SIZE >> 20, HOT_RING_SIZE >> 20, RTMEM_DEFAULT_STACK_PREFAULT >> 10,
+           COLD_BUFFER_SIZE >> 20, COLD_USED_SIZE >> 20, COLD_TABLE_SIZE >> 20);
+    printf("%-12s %10s %10s %12s %10s\n", "Mode", "RSS (MB)", "Lck (MB)", "Setup (ms)", "RT faults");
+    fflush(stdout);
+
+    for (int selective = 0; selective <= 1; ++selective) {
+        pid_t pid = fork();
+        if (pid < 0) {
+            perror("fork failed");
+            return 1;
+        }
+        if (pid == 0) {
+            run_locking(selective);
+            _exit(0);
+        }
+        int status;
+        if (waitpid(pid, &status, 0) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static void usage(const char* prog) {
+    fprintf(stderr,
+            "Usage: %s [-f] [-P] [-L] [-S size_mb] [-t threads]\n"
+            "  без флагов  mlockall + прогрев массива, проверка резидентности и цикл измерений\n"
+            "  -f  исправить найденные проверкой участки (mlock)\n"
+            "  -L  mlockall vs блокировка только горячих областей: RSS и отказы RT-пути\n"
+            "  -P  сравнить способы prefault: touch loop, MAP_POPULATE, MADV_POPULATE_WRITE, параллельный\n"
+            "  -S  размер области в МБ (по умолчанию %d)\n"
+            "  -t  потоков для параллельного prefault (по умолчанию 0 — по числу процессоров)\n",
+            prog, ARRAY_SIZE / (1024 * 1024));
+}
+
+int main(int argc, char** argv) {
+    int prefault_mode = 0;
+    int locking_mode = 0;
+    int audit_fix = 0;
+    size_t prefault_size = ARRAY_SIZE;
+    int prefault_threads = 0;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "fPLS:t:")) != -1) {
+        switch (opt) {
+        case 'f':
+            audit_fix = 1;
+            break;
+        case 'P':
+            prefault_mode = 1;
+            break;
+        case 'L':
+            locking_mode = 1;
+            break;
+        case 'S':
+            prefault_size = (size_t)strtoull(optarg, NULL, 0) * 1024 * 1024;
+            break;
+        case 't':
+            prefault_threads = atoi(optarg);
+            break;
+        default:
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (locking_mode) {
+        return benchmark_locking();
+    }
+    if (prefault_mode) {
+        if (prefault_size == 0) {
+            usage(argv[0]);
+            return 1;
+        }
+        return benchmark_prefault(prefault_size, prefault_threads);
+    }
+
     printf("Task 2: Preventing Page Faults with mlockall\n");
 
     // Заблокировать текущую и будущую память процесса в RAM
@@ -37,6 +290,11 @@ int main() {
     }
     printf("Memory pre-faulting complete.\n");
 
+    // Проверка перед циклом: все отображения процесса должны быть в RAM и заблокированы
+    if (memaudit_run(audit_fix ? MEMAUDIT_FIX : 0, stdout, NULL) != 0) {
+        printf("WARNING: some memory is not resident or not locked; run with -f to fix\n");
+    }
+
     struct timespec start_time, end_time;
     struct rusage usage_before, usage_after;
 
@@ -1,18 +1,110 @@
-#define _POSIX_C_SOURCE 200809L
+#define _GNU_SOURCE
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <limits.h>
+#include <sched.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
 #include <time.h>
+#include <malloc.h>
+#include <sys/ioctl.h>
 #include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
 #include "mempool.h"
+#include "magazine.h"
+#include "slab.h"
+#include "arena.h"
+#include "tlsf.h"
+#include "objcache.h"
+#include "rtmem.h"
 
 #define BENCH_ITERATIONS 1000000
 #define BLOCK_SIZE 128
+#define MT_BATCH 16 // Сколько блоков поток держит одновременно в многопоточном режиме
+#define MAG_ROUNDS 32 // Емкость магазина потока
+#define MIXED_LIVE 1024 // Количество одновременно живых объектов в смешанном сценарии
+#define LARGE_BLOCK_COUNT (1024 * 1024) // Большой пул: 1M блоков по BLOCK_SIZE
+#define TLB_ACCESSES 4000000 // Случайных обращений к блокам при замере TLB
+#define GROW_INITIAL 4096 // Начальный размер растущего пула, блоков
+#define GROW_TOTAL (256 * 1024) // Сколько блоков выделяет RT-цикл в сценарии роста
+#define GROW_BURST 256 // Блоков за один период RT-цикла
+#define GROW_PERIOD_NS 100000 // Период RT-цикла, нс
+#define GROW_REPORT_EVERY (32 * 1024) // Строка отчета каждые N выделений
+#define CYCLE_COUNT 100000 // Циклов в сценарии временной памяти
+#define CYCLE_OBJECTS 32 // Временных объектов за один цикл
+#define CYCLE_MAX_OBJECT 256 // Максимальный размер временного объекта
+#define CYCLE_SIZES 1024 // Длина заранее сгенерированной таблицы размеров
+#define FS_WRITES 20000000 // Записей каждого потока в свой блок (false sharing)
+#define CONFLICT_BLOCKS 64 // Блоков по 4 КБ в обходе на конфликтные промахи
+#define CONFLICT_ROUNDS 200000 // Проходов по этим блокам
+#define BURST_SIZE 32 // Блоков в одной пачке сообщений
+#define BURST_ROUNDS 200000 // Пачек на поток в сценарии пачек
+#define TLSF_LIVE 1024 // Живых буферов в сценарии переменных размеров
+#define TLSF_CAPACITY (8 * 1024 * 1024) // Область TLSF, байт
+#define OBJ_LIVE 64 // Одновременно используемых объектов в сценарии кэша объектов
+#define OBJ_ROUNDS 20000 // Циклов получения и возврата OBJ_LIVE объектов
+#define TRIM_BLOCKS (256 * 1024) // Блоков в пуле сценария простоя после пика
+#define TRIM_KEEP_EVERY 4096 // После пика остается выданным каждый N-й блок
+#define SUITE_OPS 200000 // Выделений на поток в наборе сценариев (по умолчанию)
+#define SUITE_WINDOW 256 // Живых блоков на поток в сценариях lifo/fifo/random
+#define SUITE_RING 1024 // Емкость очереди производитель -> потребитель
+#define SUITE_MAX_VALUES 16 // Наибольшая длина списков в параметрах набора
+#define STATS_SAMPLE_PERIOD 64 // Засекать каждое N-е выделение для гистограммы статистики пула
 
 long long timespec_diff_ns(struct timespec start, struct timespec end) {
     return (end.tv_sec - start.tv_sec) * 1000000000LL + (end.tv_nsec - start.tv_nsec);
 }
 
+// Отметки времени рабочего потока: сразу после общего барьера и перед выходом.
+// Главный поток просыпается после барьера позже рабочих (а при малой нагрузке и
+// после их завершения), поэтому общее время считается только по этим отметкам
+typedef struct {
+    struct timespec start;
+    struct timespec end;
+} ThreadSpan;
+
+// Расширяет total до отрезка от самого раннего старта до самого позднего завершения
+static void span_merge(ThreadSpan* total, const ThreadSpan* span, int first) {
+    if (first || timespec_diff_ns(span->start, total->start) > 0) total->start = span->start;
+    if (first || timespec_diff_ns(total->end, span->end) > 0) total->end = span->end;
+}
+
+// Верхняя граница корзины гистограммы, в которую попадает доля q выборок
+static unsigned long long stats_percentile_ns(const PoolStats* stats, double q) {
+    unsigned long long target = (unsigned long long)(q * stats->latency_samples);
+    if (target >= stats->latency_samples) target = stats->latency_samples - 1;
+    unsigned long long seen = 0;
+    for (int i = 0; i < POOL_STATS_BUCKETS; ++i) {
+        seen += stats->latency_hist[i];
+        if (seen > target) return 2ULL << i;
+    }
+    return 2ULL << (POOL_STATS_BUCKETS - 1);
+}
+
+static void print_stats(const char* name, const PoolStats* stats) {
+    printf("%s stats: in use %zu, peak %zu, allocs %llu, frees %llu, failed %llu\n", name,
+           stats->in_use, stats->peak_in_use, stats->alloc_count, stats->free_count, stats->failed_count);
+    if (stats->latency_samples > 0) {
+        printf("%s stats: alloc latency (%llu samples) p50 < %llu ns, p99 < %llu ns, max < %llu ns\n",
+               name, stats->latency_samples, stats_percentile_ns(stats, 0.5),
+               stats_percentile_ns(stats, 0.99), stats_percentile_ns(stats, 1.0));
+    }
+}
+
+// Печатает статистику пула (ничего не печатает, если собрано без POOL_STATS)
+static void print_pool_stats(const char* name, const MemoryPool* pool) {
+    PoolStats stats;
+    if (pool_stats(pool, &stats) == 0) {
+        print_stats(name, &stats);
+    }
+}
+
 void benchmark_malloc() {
     printf("Benchmarking malloc/free...\n");
     struct timespec start, end;
@@ -41,7 +133,8 @@ void benchmark_mempool() {
     void* ptrs[BENCH_ITERATIONS];
 
     // Создать пул с достаточным количеством блоков
-    MemoryPool* pool = pool_create(BLOCK_SIZE, BENCH_ITERATIONS);
+    PoolOptions opts = { .stats_sample_period = STATS_SAMPLE_PERIOD };
+    MemoryPool* pool = pool_create_ex(BLOCK_SIZE, BENCH_ITERATIONS, &opts);
     if (!pool) {
         printf("Failed to create memory pool\n");
         return;
@@ -62,17 +155,1835 @@ void benchmark_mempool() {
     }
 
     printf("pool_alloc max latency: %lld ns\n", max_latency);
+    print_pool_stats("pool_alloc", pool);
 
     // Уничтожить пул
     pool_destroy(pool);
 }
 
-int main() {
-    if (mlockall(MCL_CURRENT | MCL_FUTURE) != 0) {
+// Варианты пула в многопоточном бенчмарке
+typedef enum {
+    MT_MUTEX,    // Обычный пул под мьютексом
+    MT_LOCKFREE, // POOL_CONCURRENT: pool_alloc_mt/pool_free_mt
+    MT_MAGAZINE, // Магазины потоков поверх lock-free пула
+} MtVariant;
+
+static const char* mt_variant_name[] = { "mutex pool", "lock-free pool", "magazine cache" };
+
+// Аргументы потока многопоточного бенчмарка
+typedef struct {
+    MtVariant variant;
+    MemoryPool* pool;
+    pthread_mutex_t* lock;
+    MagazineCache* cache;
+    pthread_barrier_t* start;
+    int iterations;
+    long long ops;          // Выполнено пар alloc+free в проходе на пропускную способность
+    long long max_latency;  // Наибольшая задержка выделения в проходе с замером каждого вызова
+    ThreadSpan span;
+} MtWorker;
+
+typedef struct {
+    long long max_latency;
+    double mops;
+    int has_stats;
+    PoolStats stats;
+} MtResult;
+
+// Один проход: iterations пар alloc+free пачками по MT_BATCH. timed — засекать каждое
+// выделение; без замера проход дает пропускную способность, не искаженную вызовами часов
+static long long mt_pass(MtWorker* w, MagazineThread* mag, int timed) {
+    void* ptrs[MT_BATCH];
+    struct timespec start, end;
+    long long ops = 0;
+
+    for (int i = 0; i < w->iterations; i += MT_BATCH) {
+        for (int j = 0; j < MT_BATCH; ++j) {
+            if (timed) clock_gettime(CLOCK_MONOTONIC, &start);
+            switch (w->variant) {
+                case MT_MUTEX:
+                    pthread_mutex_lock(w->lock);
+                    ptrs[j] = pool_alloc(w->pool);
+                    pthread_mutex_unlock(w->lock);
+                    break;
+                case MT_LOCKFREE:
+                    ptrs[j] = pool_alloc_mt(w->pool);
+                    break;
+                case MT_MAGAZINE:
+                    ptrs[j] = magazine_alloc(mag);
+                    break;
+            }
+            if (timed) {
+                clock_gettime(CLOCK_MONOTONIC, &end);
+                long long latency = timespec_diff_ns(start, end);
+                if (latency > w->max_latency) w->max_latency = latency;
+            }
+            *(volatile char*)ptrs[j] = (char)j;
+        }
+        for (int j = 0; j < MT_BATCH; ++j) {
+            switch (w->variant) {
+                case MT_MUTEX:
+                    pthread_mutex_lock(w->lock);
+                    pool_free(w->pool, ptrs[j]);
+                    pthread_mutex_unlock(w->lock);
+                    break;
+                case MT_LOCKFREE:
+                    pool_free_mt(w->pool, ptrs[j]);
+                    break;
+                case MT_MAGAZINE:
+                    magazine_free(mag, ptrs[j]);
+                    break;
+            }
+        }
+        ops += MT_BATCH;
+    }
+    return ops;
+}
+
+static void* mt_worker(void* arg) {
+    MtWorker* w = (MtWorker*)arg;
+
+    MagazineThread* mag = NULL;
+    if (w->variant == MT_MAGAZINE) {
+        mag = magazine_thread_attach(w->cache);
+    }
+
+    // Проход на пропускную способность, затем (все потоки снова вместе) — на задержки
+    pthread_barrier_wait(w->start);
+    clock_gettime(CLOCK_MONOTONIC, &w->span.start);
+    w->ops = mt_pass(w, mag, 0);
+    clock_gettime(CLOCK_MONOTONIC, &w->span.end);
+
+    pthread_barrier_wait(w->start);
+    mt_pass(w, mag, 1);
+
+    magazine_thread_detach(mag);
+    return NULL;
+}
+
+MtResult benchmark_mempool_mt(int threads, MtVariant variant) {
+    MtResult result = { .max_latency = -1 };
+
+    // Магазины каждого потока могут удерживать до 2 * MAG_ROUNDS блоков
+    size_t block_count = (size_t)threads * MT_BATCH;
+    if (variant == MT_MAGAZINE) {
+        block_count += (size_t)threads * 2 * MAG_ROUNDS;
+    }
+    PoolOptions opts = {
+        .flags = variant == MT_MUTEX ? 0 : POOL_CONCURRENT,
+        .stats_sample_period = STATS_SAMPLE_PERIOD,
+    };
+    MemoryPool* pool = pool_create_ex(BLOCK_SIZE, block_count, &opts);
+    MagazineCache* cache = NULL;
+    if (pool && variant == MT_MAGAZINE) {
+        cache = magazine_cache_create(pool, MAG_ROUNDS, (size_t)threads * 2 + block_count / MAG_ROUNDS);
+    }
+    MtWorker* workers = calloc((size_t)threads, sizeof(MtWorker));
+    pthread_t* tids = calloc((size_t)threads, sizeof(pthread_t));
+    if (!pool || (variant == MT_MAGAZINE && !cache) || !workers || !tids) {
+        printf("Failed to create memory pool\n");
+        magazine_cache_destroy(cache);
+        pool_destroy(pool);
+        free(workers);
+        free(tids);
+        return result;
+    }
+
+    pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+    pthread_barrier_t barrier;
+    pthread_barrier_init(&barrier, NULL, (unsigned)threads + 1);
+
+    for (int t = 0; t < threads; ++t) {
+        workers[t].variant = variant;
+        workers[t].pool = pool;
+        workers[t].lock = &lock;
+        workers[t].cache = cache;
+        workers[t].start = &barrier;
+        workers[t].iterations = BENCH_ITERATIONS / threads;
+        pthread_create(&tids[t], NULL, mt_worker, &workers[t]);
+    }
+
+    pthread_barrier_wait(&barrier);
+    pthread_barrier_wait(&barrier); // Потоки закончили проход на пропускную способность
+    long long total_ops = 0;
+    ThreadSpan span;
+    result.max_latency = 0;
+    for (int t = 0; t < threads; ++t) {
+        pthread_join(tids[t], NULL);
+        if (workers[t].max_latency > result.max_latency) result.max_latency = workers[t].max_latency;
+        total_ops += workers[t].ops;
+        span_merge(&span, &workers[t].span, t == 0);
+    }
+    result.mops = total_ops / (timespec_diff_ns(span.start, span.end) / 1e9) / 1e6;
+
+    pthread_barrier_destroy(&barrier);
+    magazine_cache_destroy(cache);
+    // Снимок после возврата магазинов: блоки, удержанные в кэше, в нем уже не числятся
+    result.has_stats = pool_stats(pool, &result.stats) == 0;
+    pool_destroy(pool);
+    free(workers);
+    free(tids);
+    return result;
+}
+
+void benchmark_mt_compare(int threads) {
+    for (int v = MT_MUTEX; v <= MT_MAGAZINE; ++v) {
+        printf("Benchmarking %s with %d threads...\n", mt_variant_name[v], threads);
+        MtResult r = benchmark_mempool_mt(threads, (MtVariant)v);
+        printf("%s max alloc latency: %lld ns\n", mt_variant_name[v], r.max_latency);
+        printf("%s throughput: %.2f Mops/s (alloc+free pairs)\n", mt_variant_name[v], r.mops);
+        if (r.has_stats) {
+            print_stats(mt_variant_name[v], &r.stats);
+        }
+        printf("\n");
+    }
+}
+
+// Масштабирование: 1, 2, 4, ... max_threads потоков для каждого варианта
+void benchmark_mt_scaling(int max_threads) {
+    printf("%-8s", "threads");
+    for (int v = MT_MUTEX; v <= MT_MAGAZINE; ++v) {
+        printf("  %16s Mops/s  %10s", mt_variant_name[v], "max ns");
+    }
+    printf("\n");
+    for (int threads = 1; threads <= max_threads; threads *= 2) {
+        printf("%-8d", threads);
+        for (int v = MT_MUTEX; v <= MT_MAGAZINE; ++v) {
+            MtResult r = benchmark_mempool_mt(threads, (MtVariant)v);
+            printf("  %23.2f  %10lld", r.mops, r.max_latency);
+        }
+        printf("\n");
+    }
+}
+
+// Смешанный трафик: размеры сообщений и их доли в процентах
+static const size_t mixed_sizes[] = { 32, 128, 512, 4096 };
+static const int mixed_weights[] = { 50, 30, 15, 5 };
+#define MIXED_CLASSES (sizeof(mixed_sizes) / sizeof(mixed_sizes[0]))
+
+typedef void* (*MixedAllocFn)(void* ctx, size_t size);
+typedef void (*MixedFreeFn)(void* ctx, void* ptr);
+
+static void* mixed_malloc(void* ctx, size_t size) { (void)ctx; return malloc(size); }
+static void mixed_free(void* ctx, void* ptr) { (void)ctx; free(ptr); }
+static void* mixed_slab_alloc(void* ctx, size_t size) { return slab_alloc((SlabAllocator*)ctx, size); }
+static void mixed_slab_free(void* ctx, void* ptr) { slab_free((SlabAllocator*)ctx, ptr); }
+
+static unsigned xorshift32(unsigned* state) {
+    unsigned x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *state = x;
+}
+
+// Последовательность (слот, размер) генерируется заранее, чтобы не замерять ГПСЧ
+typedef struct {
+    unsigned short slot;
+    unsigned short size;
+} MixedOp;
+
+static MixedOp* mixed_generate(int count) {
+    MixedOp* ops = malloc((size_t)count * sizeof(MixedOp));
+    if (!ops) return NULL;
+    unsigned seed = 12345;
+    for (int i = 0; i < count; ++i) {
+        int r = (int)(xorshift32(&seed) % 100);
+        size_t cls = 0;
+        while (cls + 1 < MIXED_CLASSES && r >= mixed_weights[cls]) {
+            r -= mixed_weights[cls++];
+        }
+        // Размер внутри класса: от предыдущего класса (не включая) до текущего
+        size_t lo = cls ? mixed_sizes[cls - 1] + 1 : 1;
+        ops[i].size = (unsigned short)(lo + xorshift32(&seed) % (mixed_sizes[cls] - lo + 1));
+        ops[i].slot = (unsigned short)(xorshift32(&seed) % MIXED_LIVE);
+    }
+    return ops;
+}
+
+// Каждая операция освобождает объект в случайном слоте и выделяет на его место новый
+void benchmark_mixed_run(const char* name, const MixedOp* ops, int count,
+                         MixedAllocFn alloc_fn, MixedFreeFn free_fn, void* ctx) {
+    static void* live[MIXED_LIVE];
+    struct timespec start, end;
+    long long max_alloc = 0, max_free = 0, total_alloc = 0;
+
+    for (int i = 0; i < MIXED_LIVE; ++i) {
+        live[i] = alloc_fn(ctx, mixed_sizes[0]);
+    }
+
+    for (int i = 0; i < count; ++i) {
+        void** slot = &live[ops[i].slot];
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        free_fn(ctx, *slot);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        long long latency = timespec_diff_ns(start, end);
+        if (latency > max_free) max_free = latency;
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        *slot = alloc_fn(ctx, ops[i].size);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        latency = timespec_diff_ns(start, end);
+        if (latency > max_alloc) max_alloc = latency;
+        total_alloc += latency;
+
+        if (*slot) *(volatile char*)*slot = 1;
+    }
+
+    for (int i = 0; i < MIXED_LIVE; ++i) {
+        free_fn(ctx, live[i]);
+    }
+
+    printf("%s alloc: avg %.1f ns, max %lld ns; free max %lld ns\n",
+           name, (double)total_alloc / count, max_alloc, max_free);
+}
+
+void benchmark_mixed(void) {
+    printf("Benchmarking mixed-size traffic (32B/128B/512B/4KB, %d live objects)...\n", MIXED_LIVE);
+    MixedOp* ops = mixed_generate(BENCH_ITERATIONS);
+    if (!ops) {
+        printf("Failed to generate workload\n");
+        return;
+    }
+
+    // Каждый класс вмещает все живые объекты, поэтому исчерпание невозможно
+    SlabClass classes[MIXED_CLASSES];
+    for (size_t i = 0; i < MIXED_CLASSES; ++i) {
+        classes[i].block_size = mixed_sizes[i];
+        classes[i].block_count = MIXED_LIVE;
+    }
+    SlabAllocator* slab = slab_create(classes, MIXED_CLASSES, NULL);
+    if (!slab) {
+        printf("Failed to create slab allocator\n");
+        free(ops);
+        return;
+    }
+
+    benchmark_mixed_run("malloc/free", ops, BENCH_ITERATIONS, mixed_malloc, mixed_free, NULL);
+    benchmark_mixed_run("slab_alloc/slab_free", ops, BENCH_ITERATIONS, mixed_slab_alloc, mixed_slab_free, slab);
+
+    slab_destroy(slab);
+    free(ops);
+}
+
+// Счетчик промахов dTLB при чтении (perf_event_open), -1 если недоступен
+static int perf_open_dtlb_misses(void) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HW_CACHE;
+    attr.config = PERF_COUNT_HW_CACHE_DTLB |
+                  (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                  (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+static const char* backing_name(PoolBacking backing) {
+    switch (backing) {
+        case POOL_BACKING_HUGETLB: return "MAP_HUGETLB";
+        case POOL_BACKING_THP:     return "THP (madvise)";
+        default:                   return "malloc (4K pages)";
+    }
+}
+
+void benchmark_hugepages_run(const char* name, unsigned flags) {
+    struct timespec start, end;
+    PoolOptions opts = { .flags = flags, .stats_sample_period = STATS_SAMPLE_PERIOD };
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    MemoryPool* pool = pool_create_ex(BLOCK_SIZE, LARGE_BLOCK_COUNT, &opts);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    void** ptrs = malloc(LARGE_BLOCK_COUNT * sizeof(void*));
+    if (!pool || !ptrs) {
+        printf("Failed to create memory pool\n");
+        pool_destroy(pool);
+        free(ptrs);
+        return;
+    }
+    printf("%s: backing %s, pool_create %.2f ms\n", name,
+           backing_name(pool_backing(pool)), timespec_diff_ns(start, end) / 1e6);
+
+    for (int i = 0; i < LARGE_BLOCK_COUNT; ++i) {
+        ptrs[i] = pool_alloc(pool);
+    }
+
+    // Случайные обращения к блокам по всей области пула
+    int fd = perf_open_dtlb_misses();
+    unsigned seed = 2463534242u;
+    if (fd >= 0) {
+        ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < TLB_ACCESSES; ++i) {
+        ((volatile char*)ptrs[xorshift32(&seed) % LARGE_BLOCK_COUNT])[0]++;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    long long misses = -1;
+    if (fd >= 0) {
+        ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+        if (read(fd, &misses, sizeof(misses)) != sizeof(misses)) misses = -1;
+        close(fd);
+    }
+
+    printf("%s: %d random accesses, %.1f ns/access, ",
+           name, TLB_ACCESSES, (double)timespec_diff_ns(start, end) / TLB_ACCESSES);
+    if (misses >= 0) {
+        printf("dTLB read misses %lld\n", misses);
+    } else {
+        printf("dTLB read misses n/a (perf_event_open unavailable)\n");
+    }
+
+    print_pool_stats(name, pool);
+    for (int i = 0; i < LARGE_BLOCK_COUNT; ++i) {
+        pool_free(pool, ptrs[i]);
+    }
+    free(ptrs);
+    pool_destroy(pool);
+}
+
+void benchmark_hugepages(void) {
+    printf("Benchmarking %d x %dB pool: 4K pages vs huge pages...\n", LARGE_BLOCK_COUNT, BLOCK_SIZE);
+    benchmark_hugepages_run("default", 0);
+    benchmark_hugepages_run("hugepages", POOL_HUGEPAGES);
+}
+
+// Резидентная память процесса (VmRSS) в КБ
+static long rss_kb(void) {
+    long pages = 0;
+    FILE* f = fopen("/proc/self/statm", "r");
+    if (!f) return -1;
+    if (fscanf(f, "%*s %ld", &pages) != 1) pages = -1;
+    fclose(f);
+    return pages < 0 ? -1 : pages * (sysconf(_SC_PAGESIZE) / 1024);
+}
+
+void benchmark_lazy_run(const char* name, unsigned flags) {
+    struct timespec start, end;
+    PoolOptions opts = { .flags = flags, .stats_sample_period = STATS_SAMPLE_PERIOD };
+    long rss_before = rss_kb();
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    MemoryPool* pool = pool_create_ex(BLOCK_SIZE, LARGE_BLOCK_COUNT, &opts);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    if (!pool) {
+        printf("Failed to create memory pool\n");
+        return;
+    }
+    long rss_created = rss_kb();
+    printf("%s: pool_create %.3f ms, RSS +%ld KB after create\n", name,
+           timespec_diff_ns(start, end) / 1e6, rss_created - rss_before);
+
+    // Выделить 10% блоков: обычный пул уже резидентен, ленивый растет по касанию
+    long long max_latency = 0;
+    for (int i = 0; i < LARGE_BLOCK_COUNT / 10; ++i) {
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        char* block = pool_alloc(pool);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        long long latency = timespec_diff_ns(start, end);
+        if (latency > max_latency) max_latency = latency;
+        block[0] = 1;
+    }
+    printf("%s: pool_alloc max latency %lld ns, RSS +%ld KB with 10%% of blocks in use\n",
+           name, max_latency, rss_kb() - rss_before);
+    print_pool_stats(name, pool);
+
+    pool_destroy(pool);
+}
+
+void benchmark_lazy(void) {
+    printf("Benchmarking %d x %dB pool: eager vs lazy free list...\n", LARGE_BLOCK_COUNT, BLOCK_SIZE);
+    benchmark_lazy_run("eager", 0);
+    benchmark_lazy_run("lazy", POOL_LAZY);
+}
+
+// RT-цикл выделяет блоки пачками раз в период, пул растет в фоне
+void benchmark_growable(void) {
+    printf("Benchmarking growable pool: %d initial blocks, %d allocations in bursts of %d every %d us...\n",
+           GROW_INITIAL, GROW_TOTAL, GROW_BURST, GROW_PERIOD_NS / 1000);
+
+    PoolOptions opts = {
+        .flags = POOL_GROWABLE,
+        .max_block_count = 2 * GROW_TOTAL,
+        .grow_low_water = 16 * 1024,
+        .grow_chunk = 16 * 1024,
+        .grow_period_us = 200,
+        .stats_sample_period = STATS_SAMPLE_PERIOD,
+    };
+    MemoryPool* pool = pool_create_ex(BLOCK_SIZE, GROW_INITIAL, &opts);
+    void** ptrs = malloc(GROW_TOTAL * sizeof(void*));
+    if (!pool || !ptrs) {
+        printf("Failed to create memory pool\n");
+        pool_destroy(pool);
+        free(ptrs);
+        return;
+    }
+
+    struct rusage usage_before, usage_after;
+    struct timespec next, start, end;
+    long long phase_max = 0;
+    int failed = 0, phase_failed = 0;
+
+    printf("%-12s %-12s %-16s %-8s\n", "allocated", "pool blocks", "max latency ns", "failed");
+    getrusage(RUSAGE_THREAD, &usage_before);
+    clock_gettime(CLOCK_MONOTONIC, &next);
+    for (int i = 0; i < GROW_TOTAL; ++i) {
+        if (i % GROW_BURST == 0) {
+            next.tv_nsec += GROW_PERIOD_NS;
+            if (next.tv_nsec >= 1000000000L) {
+                next.tv_nsec -= 1000000000L;
+                next.tv_sec++;
+            }
+            clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL);
+        }
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        ptrs[i] = pool_alloc(pool);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        long long latency = timespec_diff_ns(start, end);
+        if (latency > phase_max) phase_max = latency;
+        if (ptrs[i]) {
+            *(volatile char*)ptrs[i] = 1;
+        } else {
+            phase_failed++;
+        }
+
+        if ((i + 1) % GROW_REPORT_EVERY == 0) {
+            printf("%-12d %-12zu %-16lld %-8d\n", i + 1, pool_block_count(pool), phase_max, phase_failed);
+            failed += phase_failed;
+            phase_max = 0;
+            phase_failed = 0;
+        }
+    }
+    getrusage(RUSAGE_THREAD, &usage_after);
+
+    printf("failed allocations: %d, RT thread minor faults: %ld, major faults: %ld\n", failed,
+           usage_after.ru_minflt - usage_before.ru_minflt,
+           usage_after.ru_majflt - usage_before.ru_majflt);
+    print_pool_stats("growable", pool);
+
+    for (int i = 0; i < GROW_TOTAL; ++i) {
+        pool_free(pool, ptrs[i]);
+    }
+    free(ptrs);
+    pool_destroy(pool);
+}
+
+typedef enum {
+    CYCLE_MALLOC, // malloc/free для каждого объекта
+    CYCLE_POOL,   // pool_alloc/pool_free для каждого объекта
+    CYCLE_ARENA,  // arena_alloc для объектов, arena_reset в конце цикла
+} CycleVariant;
+
+// Каждый цикл выделяет CYCLE_OBJECTS временных объектов, пишет в них и освобождает
+void benchmark_cycle_run(const char* name, CycleVariant variant, const unsigned short* sizes) {
+    PoolOptions opts = { .stats_sample_period = STATS_SAMPLE_PERIOD };
+    MemoryPool* pool = pool_create_ex(CYCLE_MAX_OBJECT, CYCLE_OBJECTS, &opts);
+    Arena* arena = arena_create(CYCLE_OBJECTS * CYCLE_MAX_OBJECT * 2);
+    if (!pool || !arena) {
+        printf("Failed to create allocators\n");
+        pool_destroy(pool);
+        arena_destroy(arena);
+        return;
+    }
+
+    void* ptrs[CYCLE_OBJECTS];
+    struct timespec start, end;
+    long long max_latency = 0, total_latency = 0;
+    int failed = 0;
+
+    for (int c = 0; c < CYCLE_COUNT; ++c) {
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (int j = 0; j < CYCLE_OBJECTS; ++j) {
+            size_t size = sizes[(c * CYCLE_OBJECTS + j) % CYCLE_SIZES];
+            switch (variant) {
+                case CYCLE_MALLOC: ptrs[j] = malloc(size); break;
+                case CYCLE_POOL:   ptrs[j] = pool_alloc(pool); break;
+                case CYCLE_ARENA:  ptrs[j] = arena_alloc(arena, size); break;
+            }
+            if (ptrs[j]) {
+                *(volatile char*)ptrs[j] = (char)j;
+            } else {
+                failed++;
+            }
+        }
+        switch (variant) {
+            case CYCLE_MALLOC:
+                for (int j = 0; j < CYCLE_OBJECTS; ++j) free(ptrs[j]);
+                break;
+            case CYCLE_POOL:
+                for (int j = 0; j < CYCLE_OBJECTS; ++j) pool_free(pool, ptrs[j]);
+                break;
+            case CYCLE_ARENA:
+                arena_reset(arena);
+                break;
+        }
+        clock_gettime(CLOCK_MONOTONIC, &end);
+
+        long long latency = timespec_diff_ns(start, end);
+        if (latency > max_latency) max_latency = latency;
+        total_latency += latency;
+    }
+
+    printf("%s: per-cycle avg %.1f ns, max %lld ns, failed %d\n",
+           name, (double)total_latency / CYCLE_COUNT, max_latency, failed);
+    if (variant == CYCLE_ARENA) {
+        printf("%s: peak usage %zu bytes\n", name, arena_peak(arena));
+    }
+    if (variant == CYCLE_POOL) {
+        print_pool_stats(name, pool);
+    }
+
+    pool_destroy(pool);
+    arena_destroy(arena);
+}
+
+void benchmark_cycle(void) {
+    printf("Benchmarking per-cycle scratch memory: %d cycles x %d objects of 1..%d bytes...\n",
+           CYCLE_COUNT, CYCLE_OBJECTS, CYCLE_MAX_OBJECT);
+
+    unsigned short sizes[CYCLE_SIZES];
+    unsigned seed = 88172645u;
+    for (int i = 0; i < CYCLE_SIZES; ++i) {
+        sizes[i] = (unsigned short)(1 + xorshift32(&seed) % CYCLE_MAX_OBJECT);
+    }
+
+    benchmark_cycle_run("malloc/free", CYCLE_MALLOC, sizes);
+    benchmark_cycle_run("pool_alloc/pool_free", CYCLE_POOL, sizes);
+    benchmark_cycle_run("arena_alloc/arena_reset", CYCLE_ARENA, sizes);
+}
+
+typedef struct {
+    volatile long long* first; // Начало и конец своего блока
+    volatile long long* last;
+    pthread_barrier_t* start;
+    ThreadSpan span;
+} FsWorker;
+
+static void* fs_worker(void* arg) {
+    FsWorker* w = (FsWorker*)arg;
+    pthread_barrier_wait(w->start);
+    clock_gettime(CLOCK_MONOTONIC, &w->span.start);
+    for (int i = 0; i < FS_WRITES; ++i) {
+        (*w->first)++;
+        (*w->last)++;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &w->span.end);
+    return NULL;
+}
+
+// Потоки пишут каждый в свой соседний блок; без выравнивания соседи делят кэш-линии
+void benchmark_false_sharing_run(const char* name, int threads, size_t block_align) {
+    PoolOptions opts = { .block_align = block_align };
+    MemoryPool* pool = pool_create_ex(BLOCK_SIZE, (size_t)threads, &opts);
+    FsWorker* workers = calloc((size_t)threads, sizeof(FsWorker));
+    pthread_t* tids = calloc((size_t)threads, sizeof(pthread_t));
+    if (!pool || !workers || !tids) {
+        printf("Failed to create memory pool\n");
+        pool_destroy(pool);
+        free(workers);
+        free(tids);
+        return;
+    }
+
+    pthread_barrier_t barrier;
+    pthread_barrier_init(&barrier, NULL, (unsigned)threads + 1);
+    for (int t = 0; t < threads; ++t) {
+        char* block = pool_alloc(pool);
+        workers[t].first = (volatile long long*)block;
+        workers[t].last = (volatile long long*)(block + BLOCK_SIZE - sizeof(long long));
+        workers[t].start = &barrier;
+        pthread_create(&tids[t], NULL, fs_worker, &workers[t]);
+    }
+
+    pthread_barrier_wait(&barrier);
+    ThreadSpan span;
+    for (int t = 0; t < threads; ++t) {
+        pthread_join(tids[t], NULL);
+        span_merge(&span, &workers[t].span, t == 0);
+    }
+
+    printf("%s: %d threads, first block at %p (offset %zu in cache line), %.2f ns/write\n",
+           name, threads, (void*)workers[0].first, (size_t)((uintptr_t)workers[0].first % 64),
+           (double)timespec_diff_ns(span.start, span.end) / ((double)FS_WRITES * 2));
+
+    pthread_barrier_destroy(&barrier);
+    pool_destroy(pool);
+    free(workers);
+    free(tids);
+}
+
+// Обход первых кэш-линий блоков по 4 КБ: без раскраски все попадают в один набор L1
+void benchmark_conflict_run(const char* name, size_t color_slab_size) {
+    PoolOptions opts = { .block_align = 64, .color_slab_size = color_slab_size };
+    MemoryPool* pool = pool_create_ex(4096, CONFLICT_BLOCKS, &opts);
+    if (!pool) {
+        printf("Failed to create memory pool\n");
+        return;
+    }
+
+    volatile long long* lines[CONFLICT_BLOCKS];
+    for (int i = 0; i < CONFLICT_BLOCKS; ++i) {
+        lines[i] = pool_alloc(pool);
+    }
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int r = 0; r < CONFLICT_ROUNDS; ++r) {
+        for (int i = 0; i < CONFLICT_BLOCKS; ++i) {
+            (*lines[i])++;
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    printf("%s: %d blocks of 4096B, %.2f ns/access\n", name, CONFLICT_BLOCKS,
+           (double)timespec_diff_ns(start, end) / ((double)CONFLICT_ROUNDS * CONFLICT_BLOCKS));
+    pool_destroy(pool);
+}
+
+void benchmark_cache_layout(int threads) {
+    printf("Benchmarking false sharing between neighbouring %dB blocks...\n", BLOCK_SIZE);
+    benchmark_false_sharing_run("packed", threads, 0);
+    benchmark_false_sharing_run("aligned 64B", threads, 64);
+
+    printf("\nBenchmarking conflict misses on same-stride blocks...\n");
+    benchmark_conflict_run("no coloring", 0);
+    benchmark_conflict_run("colored slabs", 8192);
+}
+
+typedef struct {
+    MemoryPool* pool;
+    int concurrent;
+    int batch;
+    pthread_barrier_t* start;
+    long long max_latency;
+    int failed;
+    ThreadSpan span;
+} BurstWorker;
+
+// Пачка из BURST_SIZE блоков: выделить, записать, освободить — поштучно или одним вызовом
+static void* burst_worker(void* arg) {
+    BurstWorker* w = (BurstWorker*)arg;
+    void* blocks[BURST_SIZE];
+    struct timespec start, end;
+    w->max_latency = 0;
+    w->failed = 0;
+    pthread_barrier_wait(w->start);
+    clock_gettime(CLOCK_MONOTONIC, &w->span.start);
+
+    for (int r = 0; r < BURST_ROUNDS; ++r) {
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        size_t got = 0;
+        if (w->batch) {
+            got = w->concurrent ? pool_alloc_mt_n(w->pool, blocks, BURST_SIZE)
+                                : pool_alloc_n(w->pool, blocks, BURST_SIZE);
+        } else {
+            for (; got < BURST_SIZE; ++got) {
+                blocks[got] = w->concurrent ? pool_alloc_mt(w->pool) : pool_alloc(w->pool);
+                if (!blocks[got]) break;
+            }
+        }
+        for (size_t i = 0; i < got; ++i) {
+            *(volatile char*)blocks[i] = (char)i;
+        }
+        if (w->batch) {
+            if (w->concurrent) {
+                pool_free_mt_n(w->pool, blocks, got);
+            } else {
+                pool_free_n(w->pool, blocks, got);
+            }
+        } else {
+            for (size_t i = 0; i < got; ++i) {
+                if (w->concurrent) {
+                    pool_free_mt(w->pool, blocks[i]);
+                } else {
+                    pool_free(w->pool, blocks[i]);
+                }
+            }
+        }
+        clock_gettime(CLOCK_MONOTONIC, &end);
+
+        long long latency = timespec_diff_ns(start, end);
+        if (latency > w->max_latency) w->max_latency = latency;
+        if (got < BURST_SIZE) w->failed++;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &w->span.end);
+    return NULL;
+}
+
+void benchmark_burst_run(const char* name, int threads, int concurrent, int batch) {
+    PoolOptions opts = {
+        .flags = concurrent ? POOL_CONCURRENT : 0,
+        .stats_sample_period = STATS_SAMPLE_PERIOD,
+    };
+    MemoryPool* pool = pool_create_ex(BLOCK_SIZE, (size_t)threads * BURST_SIZE, &opts);
+    BurstWorker* workers = calloc((size_t)threads, sizeof(BurstWorker));
+    pthread_t* tids = calloc((size_t)threads, sizeof(pthread_t));
+    if (!pool || !workers || !tids) {
+        printf("Failed to create memory pool\n");
+        pool_destroy(pool);
+        free(workers);
+        free(tids);
+        return;
+    }
+
+    pthread_barrier_t barrier;
+    pthread_barrier_init(&barrier, NULL, (unsigned)threads + 1);
+    for (int t = 0; t < threads; ++t) {
+        workers[t].pool = pool;
+        workers[t].concurrent = concurrent;
+        workers[t].batch = batch;
+        workers[t].start = &barrier;
+        pthread_create(&tids[t], NULL, burst_worker, &workers[t]);
+    }
+
+    pthread_barrier_wait(&barrier);
+    long long max_latency = 0;
+    int failed = 0;
+    ThreadSpan span;
+    for (int t = 0; t < threads; ++t) {
+        pthread_join(tids[t], NULL);
+        if (workers[t].max_latency > max_latency) max_latency = workers[t].max_latency;
+        failed += workers[t].failed;
+        span_merge(&span, &workers[t].span, t == 0);
+    }
+
+    double bursts = (double)threads * BURST_ROUNDS;
+    printf("%s: %.1f ns/burst, max %lld ns, short bursts %d\n",
+           name, timespec_diff_ns(span.start, span.end) / bursts * threads, max_latency, failed);
+    print_pool_stats(name, pool);
+
+    pthread_barrier_destroy(&barrier);
+    pool_destroy(pool);
+    free(workers);
+    free(tids);
+}
+
+void benchmark_burst(int threads) {
+    printf("Benchmarking bursts of %d blocks: per-block calls vs batch API...\n", BURST_SIZE);
+    benchmark_burst_run("pool_alloc/pool_free", 1, 0, 0);
+    benchmark_burst_run("pool_alloc_n/pool_free_n", 1, 0, 1);
+
+    printf("\n%d threads on a POOL_CONCURRENT pool:\n", threads);
+    benchmark_burst_run("pool_alloc_mt/pool_free_mt", threads, 1, 0);
+    benchmark_burst_run("pool_alloc_mt_n/pool_free_mt_n", threads, 1, 1);
+}
+
+// Распределения размеров буферов для сравнения TLSF, пула и malloc
+typedef enum {
+    DIST_SMALL,   // Короткие сообщения: равномерно 16..256 Б
+    DIST_PAYLOAD, // Данные из сокета: лог-равномерно 64 Б..16 КБ
+    DIST_BIMODAL, // 80% заголовков 48..128 Б, 20% кадров 1..9 КБ (MTU/jumbo)
+} SizeDist;
+
+static const char* dist_name[] = { "small 16..256B", "payloads 64B..16KB", "bimodal headers/frames" };
+static const size_t dist_max[] = { 256, 16384, 9000 };
+
+static MixedOp* tlsf_generate(SizeDist dist, int count) {
+    MixedOp* ops = malloc((size_t)count * sizeof(MixedOp));
+    if (!ops) return NULL;
+    unsigned seed = 362436069u;
+    for (int i = 0; i < count; ++i) {
+        size_t size;
+        switch (dist) {
+            case DIST_SMALL:
+                size = 16 + xorshift32(&seed) % (256 - 16 + 1);
+                break;
+            case DIST_PAYLOAD: {
+                // Степень двойки равновероятна, внутри нее — равномерно
+                unsigned e = 6 + xorshift32(&seed) % 8;
+                size = ((size_t)1 << e) + xorshift32(&seed) % ((size_t)1 << e);
+                break;
+            }
+            default:
+                size = xorshift32(&seed) % 100 < 80 ? 48 + xorshift32(&seed) % (128 - 48 + 1)
+                                                     : 1024 + xorshift32(&seed) % (9000 - 1024 + 1);
+                break;
+        }
+        ops[i].size = (unsigned short)(size > dist_max[dist] ? dist_max[dist] : size);
+        ops[i].slot = (unsigned short)(xorshift32(&seed) % TLSF_LIVE);
+    }
+    return ops;
+}
+
+typedef enum {
+    VAR_MALLOC, // glibc malloc/free
+    VAR_POOL,   // MemoryPool с блоком под наибольший размер распределения
+    VAR_TLSF,   // tlsf_alloc/tlsf_free
+} VarVariant;
+
+// Как в смешанном сценарии: освободить буфер в случайном слоте и выделить новый
+void benchmark_tlsf_run(const char* name, VarVariant variant, SizeDist dist, const MixedOp* ops, int count) {
+    static void* live[TLSF_LIVE];
+    static size_t live_size[TLSF_LIVE];
+    MemoryPool* pool = NULL;
+    Tlsf* tlsf = NULL;
+    if (variant == VAR_POOL) {
+        pool = pool_create(dist_max[dist], TLSF_LIVE);
+    } else if (variant == VAR_TLSF) {
+        tlsf = tlsf_create(TLSF_CAPACITY);
+    }
+    if ((variant == VAR_POOL && !pool) || (variant == VAR_TLSF && !tlsf)) {
+        printf("Failed to create allocator\n");
+        return;
+    }
+    size_t malloc_before = mallinfo2().uordblks;
+    memset(live, 0, sizeof(live));
+    memset(live_size, 0, sizeof(live_size));
+
+    struct timespec start, end;
+    long long max_alloc = 0, max_free = 0, total_alloc = 0;
+    int failed = 0;
+    for (int i = 0; i < count; ++i) {
+        int slot = ops[i].slot;
+        size_t size = ops[i].size;
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        switch (variant) {
+            case VAR_MALLOC: free(live[slot]); break;
+            case VAR_POOL:   pool_free(pool, live[slot]); break;
+            case VAR_TLSF:   tlsf_free(tlsf, live[slot]); break;
+        }
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        long long latency = timespec_diff_ns(start, end);
+        if (latency > max_free) max_free = latency;
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        switch (variant) {
+            case VAR_MALLOC: live[slot] = malloc(size); break;
+            case VAR_POOL:   live[slot] = pool_alloc(pool); break;
+            case VAR_TLSF:   live[slot] = tlsf_alloc(tlsf, size); break;
+        }
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        latency = timespec_diff_ns(start, end);
+        if (latency > max_alloc) max_alloc = latency;
+        total_alloc += latency;
+
+        if (live[slot]) {
+            ((volatile char*)live[slot])[size - 1] = 1;
+            live_size[slot] = size;
+        } else {
+            live_size[slot] = 0;
+            failed++;
+        }
+    }
+
+    // Сколько памяти аллокатор занимает под живые буферы (с заголовками и округлением)
+    size_t live_bytes = 0, live_count = 0;
+    for (int i = 0; i < TLSF_LIVE; ++i) {
+        live_bytes += live_size[i];
+        live_count += live[i] != NULL;
+    }
+    size_t held = 0;
+    switch (variant) {
+        case VAR_MALLOC: held = mallinfo2().uordblks - malloc_before; break;
+        case VAR_POOL:   held = live_count * dist_max[dist]; break;
+        case VAR_TLSF:   held = TLSF_CAPACITY - tlsf_free_bytes(tlsf); break;
+    }
+
+    printf("%-7s alloc avg %6.1f ns, max %7lld ns; free max %7lld ns; failed %d; "
+           "live %zu KB, held %zu KB (+%.0f%%)\n",
+           name, (double)total_alloc / count, max_alloc, max_free, failed,
+           live_bytes / 1024, held / 1024, live_bytes ? 100.0 * ((double)held / live_bytes - 1) : 0.0);
+    if (variant == VAR_TLSF) {
+        size_t free_bytes = tlsf_free_bytes(tlsf);
+        size_t largest = tlsf_largest_free(tlsf);
+        printf("%-7s free space fragmentation %.1f%% (largest free block %zu KB of %zu KB free)\n",
+               name, free_bytes ? 100.0 * (1.0 - (double)largest / free_bytes) : 0.0,
+               largest / 1024, free_bytes / 1024);
+    }
+
+    for (int i = 0; i < TLSF_LIVE; ++i) {
+        switch (variant) {
+            case VAR_MALLOC: free(live[i]); break;
+            case VAR_POOL:   pool_free(pool, live[i]); break;
+            case VAR_TLSF:   tlsf_free(tlsf, live[i]); break;
+        }
+    }
+    pool_destroy(pool);
+    tlsf_destroy(tlsf);
+}
+
+void benchmark_tlsf(void) {
+    printf("Benchmarking variable-size buffers (%d live, TLSF region %d MB): malloc vs pool vs TLSF...\n",
+           TLSF_LIVE, TLSF_CAPACITY / (1024 * 1024));
+    for (int d = DIST_SMALL; d <= DIST_BIMODAL; ++d) {
+        MixedOp* ops = tlsf_generate((SizeDist)d, BENCH_ITERATIONS);
+        if (!ops) {
+            printf("Failed to generate workload\n");
+            return;
+        }
+        printf("\n%s (pool block %zu B):\n", dist_name[d], dist_max[d]);
+        benchmark_tlsf_run("malloc", VAR_MALLOC, (SizeDist)d, ops, BENCH_ITERATIONS);
+        benchmark_tlsf_run("pool", VAR_POOL, (SizeDist)d, ops, BENCH_ITERATIONS);
+        benchmark_tlsf_run("tlsf", VAR_TLSF, (SizeDist)d, ops, BENCH_ITERATIONS);
+        free(ops);
+    }
+}
+
+// Состояние соединения: дорогая инициализация, дешевое повторное использование
+typedef struct {
+    pthread_mutex_t lock;
+    uint32_t crc_table[256]; // Таблица CRC32 для проверки сообщений
+    size_t bytes_in;         // Меняется при каждом использовании
+    char rx_buffer[2048];
+} ConnState;
+
+static int conn_state_ctor(void* obj, void* arg) {
+    (void)arg;
+    ConnState* conn = (ConnState*)obj;
+    if (pthread_mutex_init(&conn->lock, NULL) != 0) return -1;
+    for (uint32_t i = 0; i < 256; ++i) {
+        uint32_t crc = i;
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1)));
+        }
+        conn->crc_table[i] = crc;
+    }
+    memset(conn->rx_buffer, 0, sizeof(conn->rx_buffer));
+    conn->bytes_in = 0;
+    return 0;
+}
+
+static void conn_state_dtor(void* obj, void* arg) {
+    (void)arg;
+    pthread_mutex_destroy(&((ConnState*)obj)->lock);
+}
+
+typedef enum {
+    OBJ_MALLOC, // malloc + конструктор, деструктор + free на каждое использование
+    OBJ_POOL,   // pool_alloc + конструктор, деструктор + pool_free
+    OBJ_CACHE,  // objcache_alloc/objcache_free, сброс только bytes_in
+} ObjVariant;
+
+void benchmark_objcache_run(const char* name, ObjVariant variant) {
+    MemoryPool* pool = NULL;
+    ObjCache* cache = NULL;
+    if (variant == OBJ_POOL) {
+        pool = pool_create(sizeof(ConnState), OBJ_LIVE);
+    } else if (variant == OBJ_CACHE) {
+        cache = objcache_create(sizeof(ConnState), OBJ_LIVE, conn_state_ctor, conn_state_dtor, NULL, NULL);
+    }
+    if ((variant == OBJ_POOL && !pool) || (variant == OBJ_CACHE && !cache)) {
+        printf("Failed to create allocator\n");
+        return;
+    }
+
+    ConnState* conns[OBJ_LIVE];
+    struct timespec start, end;
+    long long max_get = 0, max_put = 0, total = 0;
+    uint32_t checksum = 0;
+    for (int r = 0; r < OBJ_ROUNDS; ++r) {
+        for (int i = 0; i < OBJ_LIVE; ++i) {
+            clock_gettime(CLOCK_MONOTONIC, &start);
+            ConnState* conn;
+            if (variant == OBJ_CACHE) {
+                conn = objcache_alloc(cache);
+                conn->bytes_in = 0;
+            } else {
+                conn = variant == OBJ_POOL ? pool_alloc(pool) : malloc(sizeof(ConnState));
+                conn_state_ctor(conn, NULL);
+            }
+            clock_gettime(CLOCK_MONOTONIC, &end);
+            long long latency = timespec_diff_ns(start, end);
+            if (latency > max_get) max_get = latency;
+            total += latency;
+
+            // Использование: принять несколько байт под блокировкой
+            pthread_mutex_lock(&conn->lock);
+            conn->rx_buffer[r % sizeof(conn->rx_buffer)] = (char)i;
+            conn->bytes_in += 64;
+            checksum += conn->crc_table[(r + i) & 0xFF];
+            pthread_mutex_unlock(&conn->lock);
+            conns[i] = conn;
+        }
+        for (int i = 0; i < OBJ_LIVE; ++i) {
+            clock_gettime(CLOCK_MONOTONIC, &start);
+            switch (variant) {
+                case OBJ_MALLOC:
+                    conn_state_dtor(conns[i], NULL);
+                    free(conns[i]);
+                    break;
+                case OBJ_POOL:
+                    conn_state_dtor(conns[i], NULL);
+                    pool_free(pool, conns[i]);
+                    break;
+                case OBJ_CACHE:
+                    objcache_free(cache, conns[i]);
+                    break;
+            }
+            clock_gettime(CLOCK_MONOTONIC, &end);
+            long long latency = timespec_diff_ns(start, end);
+            if (latency > max_put) max_put = latency;
+            total += latency;
+        }
+    }
+
+    printf("%-28s %.1f ns/object (get+put), get max %lld ns, put max %lld ns (checksum %08x)\n",
+           name, (double)total / ((long long)OBJ_ROUNDS * OBJ_LIVE), max_get, max_put, checksum);
+
+    pool_destroy(pool);
+    objcache_destroy(cache);
+}
+
+void benchmark_objcache(void) {
+    printf("Benchmarking %zu-byte connection state objects, %d in use per round...\n",
+           sizeof(ConnState), OBJ_LIVE);
+    benchmark_objcache_run("malloc + ctor/dtor", OBJ_MALLOC);
+    benchmark_objcache_run("pool_alloc + ctor/dtor", OBJ_POOL);
+    benchmark_objcache_run("objcache (constructed once)", OBJ_CACHE);
+}
+
+// Пик нагрузки занимает весь пул, затем почти все блоки освобождаются и пул простаивает
+void benchmark_trim_run(const char* name, unsigned flags) {
+    int mt = (flags & POOL_CONCURRENT) != 0;
+    PoolOptions opts = { .flags = flags };
+    long rss_start = rss_kb();
+    MemoryPool* pool = pool_create_ex(BLOCK_SIZE, TRIM_BLOCKS, &opts);
+    void** ptrs = malloc(TRIM_BLOCKS * sizeof(void*));
+    if (!pool || !ptrs) {
+        printf("Failed to create memory pool\n");
+        pool_destroy(pool);
+        free(ptrs);
+        return;
+    }
+
+    for (int i = 0; i < TRIM_BLOCKS; ++i) {
+        ptrs[i] = mt ? pool_alloc_mt(pool) : pool_alloc(pool);
+        memset(ptrs[i], 1, BLOCK_SIZE);
+    }
+    for (int i = 0; i < TRIM_BLOCKS; ++i) {
+        if (i % TRIM_KEEP_EVERY == 0) continue;
+        if (mt) {
+            pool_free_mt(pool, ptrs[i]);
+        } else {
+            pool_free(pool, ptrs[i]);
+        }
+    }
+    long rss_idle = rss_kb();
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    size_t released = pool_trim(pool);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    long rss_trimmed = rss_kb();
+    printf("%s: idle RSS +%ld KB, pool_trim released %zu KB in %.2f ms, RSS +%ld KB after trim\n",
+           name, rss_idle - rss_start, released / 1024, timespec_diff_ns(start, end) / 1e6,
+           rss_trimmed - rss_start);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    size_t restored = pool_restore(pool);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    printf("%s: pool_restore %zu KB in %.2f ms, RSS +%ld KB after restore\n",
+           name, restored / 1024, timespec_diff_ns(start, end) / 1e6, rss_kb() - rss_start);
+
+    // Повторный пик: после pool_restore выделение не должно вызывать page faults
+    struct rusage usage_before, usage_after;
+    long long max_latency = 0;
+    int got = 0;
+    getrusage(RUSAGE_THREAD, &usage_before);
+    for (int i = 0; i < TRIM_BLOCKS; ++i) {
+        if (i % TRIM_KEEP_EVERY == 0) continue;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        ptrs[i] = mt ? pool_alloc_mt(pool) : pool_alloc(pool);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        long long latency = timespec_diff_ns(start, end);
+        if (latency > max_latency) max_latency = latency;
+        if (ptrs[i]) {
+            *(volatile char*)ptrs[i] = 1;
+            got++;
+        }
+    }
+    getrusage(RUSAGE_THREAD, &usage_after);
+    printf("%s: next burst got %d of %d blocks, max alloc latency %lld ns, minor faults %ld\n",
+           name, got, TRIM_BLOCKS - (TRIM_BLOCKS + TRIM_KEEP_EVERY - 1) / TRIM_KEEP_EVERY, max_latency,
+           usage_after.ru_minflt - usage_before.ru_minflt);
+
+    free(ptrs);
+    pool_destroy(pool);
+}
+
+void benchmark_trim(void) {
+    printf("Benchmarking idle-after-burst: %d x %dB pool, 1 of %d blocks stays allocated...\n",
+           TRIM_BLOCKS, BLOCK_SIZE, TRIM_KEEP_EVERY);
+    benchmark_trim_run("single-threaded", 0);
+    benchmark_trim_run("concurrent", POOL_CONCURRENT);
+}
+
+// Набор сценариев (-S): аллокаторы x шаблоны x число потоков x размеры блоков
+typedef enum {
+    PAT_LIFO,     // Выделить окно блоков, освободить в обратном порядке
+    PAT_FIFO,     // Очередь: освобождается самый старый блок окна
+    PAT_RANDOM,   // Освобождается случайный блок окна
+    PAT_PRODCONS, // Пары потоков: производитель выделяет, потребитель освобождает
+    PAT_BURST,    // Пачка из BURST_SIZE выделений подряд, затем освобождений подряд
+    PAT_COUNT,
+} SuitePattern;
+
+static const char* pattern_name[] = { "lifo", "fifo", "random", "prodcons", "burst" };
+
+typedef enum {
+    SA_MALLOC,   // glibc malloc/free
+    SA_POOL,     // MemoryPool (под мьютексом, если потоков больше одного)
+    SA_LOCKFREE, // POOL_CONCURRENT: pool_alloc_mt/pool_free_mt
+    SA_MAGAZINE, // Магазины потоков поверх lock-free пула
+    SA_TLSF,     // TLSF (под мьютексом, если потоков больше одного)
+    SA_COUNT,
+} SuiteAllocKind;
+
+static const char* suite_alloc_name[] = { "malloc", "pool", "lockfree", "magazine", "tlsf" };
+
+typedef enum {
+    OUT_TABLE,
+    OUT_CSV,
+    OUT_JSON,
+} SuiteOutput;
+
+typedef struct {
+    int allocs[SA_COUNT];
+    int alloc_count;
+    int patterns[PAT_COUNT];
+    int pattern_count;
+    long threads[SUITE_MAX_VALUES];
+    int thread_count;
+    long sizes[SUITE_MAX_VALUES];
+    int size_count;
+    int ops;
+    SuiteOutput output;
+} SuiteConfig;
+
+typedef struct {
+    SuiteAllocKind kind;
+    size_t size;
+    int locked;
+    pthread_mutex_t lock;
+    MemoryPool* pool;
+    MagazineCache* cache;
+    Tlsf* tlsf;
+} SuiteAlloc;
+
+// Очередь одного производителя и одного потребителя
+typedef struct {
+    _Alignas(64) _Atomic size_t head; // Пишет производитель
+    _Alignas(64) _Atomic size_t tail; // Пишет потребитель
+    void* slots[SUITE_RING];
+} SpscRing;
+
+typedef struct {
+    SuiteAlloc* alloc;
+    SuitePattern pattern;
+    int producer;
+    SpscRing* ring;
+    pthread_barrier_t* start;
+    int ops;
+    unsigned* alloc_lat;
+    int alloc_n;
+    unsigned* free_lat;
+    int free_n;
+    int failed;
+    ThreadSpan span;
+} SuiteWorker;
+
+typedef struct {
+    unsigned long long count;
+    unsigned min, p50, p99, p999, max;
+} LatencySummary;
+
+typedef struct {
+    double mops;
+    int failed;
+    LatencySummary alloc;
+    LatencySummary free;
+} SuiteResult;
+
+static void* suite_alloc(SuiteAlloc* a, MagazineThread* mag) {
+    void* block = NULL;
+    switch (a->kind) {
+        case SA_MALLOC:
+            return malloc(a->size);
+        case SA_LOCKFREE:
+            return pool_alloc_mt(a->pool);
+        case SA_MAGAZINE:
+            return magazine_alloc(mag);
+        case SA_POOL:
+        case SA_TLSF:
+            if (a->locked) pthread_mutex_lock(&a->lock);
+            block = a->kind == SA_POOL ? pool_alloc(a->pool) : tlsf_alloc(a->tlsf, a->size);
+            if (a->locked) pthread_mutex_unlock(&a->lock);
+            return block;
+        default:
+            return NULL;
+    }
+}
+
+static void suite_free(SuiteAlloc* a, MagazineThread* mag, void* block) {
+    switch (a->kind) {
+        case SA_MALLOC:
+            free(block);
+            break;
+        case SA_LOCKFREE:
+            pool_free_mt(a->pool, block);
+            break;
+        case SA_MAGAZINE:
+            magazine_free(mag, block);
+            break;
+        case SA_POOL:
+        case SA_TLSF:
+            if (a->locked) pthread_mutex_lock(&a->lock);
+            if (a->kind == SA_POOL) {
+                pool_free(a->pool, block);
+            } else {
+                tlsf_free(a->tlsf, block);
+            }
+            if (a->locked) pthread_mutex_unlock(&a->lock);
+            break;
+        default:
+            break;
+    }
+}
+
+static inline unsigned suite_elapsed(struct timespec start, struct timespec end) {
+    long long ns = timespec_diff_ns(start, end);
+    return ns > UINT_MAX ? UINT_MAX : (unsigned)ns;
+}
+
+static void* suite_timed_alloc(SuiteWorker* w, MagazineThread* mag) {
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    void* block = suite_alloc(w->alloc, mag);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    w->alloc_lat[w->alloc_n++] = suite_elapsed(start, end);
+    if (block) {
+        *(volatile char*)block = 1;
+    } else {
+        w->failed++;
+    }
+    return block;
+}
+
+static void suite_timed_free(SuiteWorker* w, MagazineThread* mag, void* block) {
+    if (!block) return;
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    suite_free(w->alloc, mag, block);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    w->free_lat[w->free_n++] = suite_elapsed(start, end);
+}
+
+static void* suite_worker(void* arg) {
+    SuiteWorker* w = (SuiteWorker*)arg;
+    MagazineThread* mag = w->alloc->kind == SA_MAGAZINE ? magazine_thread_attach(w->alloc->cache) : NULL;
+    void* window[SUITE_WINDOW] = { 0 };
+    unsigned seed = 2463534242u + (unsigned)(uintptr_t)w;
+    if (seed == 0) seed = 1;
+
+    pthread_barrier_wait(w->start);
+    clock_gettime(CLOCK_MONOTONIC, &w->span.start);
+    switch (w->pattern) {
+        case PAT_LIFO:
+        case PAT_BURST: {
+            int window_size = w->pattern == PAT_LIFO ? SUITE_WINDOW : BURST_SIZE;
+            for (int done = 0; done < w->ops; done += window_size) {
+                int n = w->ops - done < window_size ? w->ops - done : window_size;
+                for (int i = 0; i < n; ++i) {
+                    window[i] = suite_timed_alloc(w, mag);
+                }
+                for (int i = 0; i < n; ++i) {
+                    int j = w->pattern == PAT_LIFO ? n - 1 - i : i;
+                    suite_timed_free(w, mag, window[j]);
+                    window[j] = NULL;
+                }
+            }
+            break;
+        }
+        case PAT_FIFO:
+        case PAT_RANDOM:
+            for (int i = 0; i < w->ops; ++i) {
+                int slot = w->pattern == PAT_FIFO ? i % SUITE_WINDOW : (int)(xorshift32(&seed) % SUITE_WINDOW);
+                suite_timed_free(w, mag, window[slot]);
+                window[slot] = suite_timed_alloc(w, mag);
+            }
+            for (int i = 0; i < SUITE_WINDOW; ++i) {
+                suite_timed_free(w, mag, window[i]);
+            }
+            break;
+        case PAT_PRODCONS:
+            for (int i = 0; i < w->ops; ++i) {
+                if (w->producer) {
+                    void* block = suite_timed_alloc(w, mag);
+                    size_t head = atomic_load_explicit(&w->ring->head, memory_order_relaxed);
+                    while (head - atomic_load_explicit(&w->ring->tail, memory_order_acquire) >= SUITE_RING) {
+                        sched_yield();
+                    }
+                    w->ring->slots[head % SUITE_RING] = block;
+                    atomic_store_explicit(&w->ring->head, head + 1, memory_order_release);
+                } else {
+                    size_t tail = atomic_load_explicit(&w->ring->tail, memory_order_relaxed);
+                    while (atomic_load_explicit(&w->ring->head, memory_order_acquire) == tail) {
+                        sched_yield();
+                    }
+                    void* block = w->ring->slots[tail % SUITE_RING];
+                    atomic_store_explicit(&w->ring->tail, tail + 1, memory_order_release);
+                    suite_timed_free(w, mag, block);
+                }
+            }
+            break;
+        default:
+            break;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &w->span.end);
+    magazine_thread_detach(mag);
+    return NULL;
+}
+
+static int compare_unsigned(const void* a, const void* b) {
+    unsigned x = *(const unsigned*)a;
+    unsigned y = *(const unsigned*)b;
+    return (x > y) - (x < y);
+}
+
+// Сводка по объединенным замерам всех потоков
+static LatencySummary suite_summarize(SuiteWorker* workers, int count, int alloc_side) {
+    LatencySummary summary = { 0 };
+    size_t total = 0;
+    for (int t = 0; t < count; ++t) {
+        total += (size_t)(alloc_side ? workers[t].alloc_n : workers[t].free_n);
+    }
+    unsigned* all = total ? malloc(total * sizeof(unsigned)) : NULL;
+    if (!all) return summary;
+    size_t n = 0;
+    for (int t = 0; t < count; ++t) {
+        int k = alloc_side ? workers[t].alloc_n : workers[t].free_n;
+        memcpy(all + n, alloc_side ? workers[t].alloc_lat : workers[t].free_lat, (size_t)k * sizeof(unsigned));
+        n += (size_t)k;
+    }
+    qsort(all, n, sizeof(unsigned), compare_unsigned);
+    summary.count = n;
+    summary.min = all[0];
+    summary.p50 = all[(size_t)(0.5 * (n - 1))];
+    summary.p99 = all[(size_t)(0.99 * (n - 1))];
+    summary.p999 = all[(size_t)(0.999 * (n - 1))];
+    summary.max = all[n - 1];
+    free(all);
+    return summary;
+}
+
+// Один прогон; -1, если комбинация невозможна или не удалось создать аллокатор
+static int suite_run(SuiteAllocKind kind, SuitePattern pattern, int threads, size_t size, int ops,
+                     SuiteResult* result) {
+    if (pattern == PAT_PRODCONS) {
+        threads &= ~1; // Потоки разбиваются на пары
+        if (threads < 2) return -1;
+    }
+
+    // Блоков хватает на окна всех потоков, заполненные очереди и магазины
+    size_t block_count = (size_t)threads * (SUITE_WINDOW + SUITE_RING + 1);
+    if (kind == SA_MAGAZINE) {
+        block_count += (size_t)threads * 2 * MAG_ROUNDS;
+    }
+    SuiteAlloc alloc = { .kind = kind, .size = size, .locked = threads > 1 };
+    pthread_mutex_init(&alloc.lock, NULL);
+    int ok = 1;
+    if (kind == SA_POOL || kind == SA_LOCKFREE || kind == SA_MAGAZINE) {
+        PoolOptions opts = { .flags = kind == SA_POOL ? 0 : POOL_CONCURRENT };
+        alloc.pool = pool_create_ex(size, block_count, &opts);
+        ok = alloc.pool != NULL;
+        if (ok && kind == SA_MAGAZINE) {
+            alloc.cache = magazine_cache_create(alloc.pool, MAG_ROUNDS,
+                                                (size_t)threads * 2 + block_count / MAG_ROUNDS);
+            ok = alloc.cache != NULL;
+        }
+    } else if (kind == SA_TLSF) {
+        alloc.tlsf = tlsf_create(block_count * (size + 2 * TLSF_ALIGN) + 1024 * 1024);
+        ok = alloc.tlsf != NULL;
+    }
+
+    SuiteWorker* workers = calloc((size_t)threads, sizeof(SuiteWorker));
+    pthread_t* tids = calloc((size_t)threads, sizeof(pthread_t));
+    SpscRing* rings = NULL;
+    if (pattern == PAT_PRODCONS) {
+        rings = aligned_alloc(64, (size_t)(threads / 2) * sizeof(SpscRing));
+    }
+    ok = ok && workers && tids && (pattern != PAT_PRODCONS || rings);
+    for (int t = 0; ok && t < threads; ++t) {
+        workers[t].alloc_lat = malloc((size_t)ops * sizeof(unsigned));
+        workers[t].free_lat = malloc((size_t)ops * sizeof(unsigned));
+        ok = workers[t].alloc_lat && workers[t].free_lat;
+    }
+
+    pthread_barrier_t barrier;
+    if (ok) {
+        pthread_barrier_init(&barrier, NULL, (unsigned)threads + 1);
+        for (int t = 0; t < threads; ++t) {
+            workers[t].alloc = &alloc;
+            workers[t].pattern = pattern;
+            workers[t].start = &barrier;
+            workers[t].ops = ops;
+            if (pattern == PAT_PRODCONS) {
+                SpscRing* ring = &rings[t / 2];
+                if (t % 2 == 0) {
+                    atomic_init(&ring->head, 0);
+                    atomic_init(&ring->tail, 0);
+                }
+                workers[t].ring = ring;
+                workers[t].producer = t % 2 == 0;
+            }
+            pthread_create(&tids[t], NULL, suite_worker, &workers[t]);
+        }
+        pthread_barrier_wait(&barrier);
+        ThreadSpan span;
+        for (int t = 0; t < threads; ++t) {
+            pthread_join(tids[t], NULL);
+            span_merge(&span, &workers[t].span, t == 0);
+        }
+        pthread_barrier_destroy(&barrier);
+
+        memset(result, 0, sizeof(*result));
+        for (int t = 0; t < threads; ++t) {
+            result->failed += workers[t].failed;
+        }
+        result->alloc = suite_summarize(workers, threads, 1);
+        result->free = suite_summarize(workers, threads, 0);
+        result->mops = result->alloc.count / (timespec_diff_ns(span.start, span.end) / 1e9) / 1e6;
+    }
+
+    for (int t = 0; workers && t < threads; ++t) {
+        free(workers[t].alloc_lat);
+        free(workers[t].free_lat);
+    }
+    free(workers);
+    free(tids);
+    free(rings);
+    magazine_cache_destroy(alloc.cache);
+    pool_destroy(alloc.pool);
+    tlsf_destroy(alloc.tlsf);
+    pthread_mutex_destroy(&alloc.lock);
+    return ok ? 0 : -1;
+}
+
+static void suite_print_row(SuiteOutput output, int first, const char* alloc, const char* pattern,
+                            int threads, size_t size, const char* op, const LatencySummary* l,
+                            double mops, int failed) {
+    switch (output) {
+        case OUT_CSV:
+            printf("%s,%s,%d,%zu,%s,%llu,%u,%u,%u,%u,%u,%.3f,%d\n", alloc, pattern, threads, size, op,
+                   l->count, l->min, l->p50, l->p99, l->p999, l->max, mops, failed);
+            break;
+        case OUT_JSON:
+            printf("%s  {\"allocator\": \"%s\", \"pattern\": \"%s\", \"threads\": %d, \"block_size\": %zu, "
+                   "\"op\": \"%s\", \"count\": %llu, \"min_ns\": %u, \"p50_ns\": %u, \"p99_ns\": %u, "
+                   "\"p999_ns\": %u, \"max_ns\": %u, \"mops\": %.3f, \"failed\": %d}",
+                   first ? "" : ",\n", alloc, pattern, threads, size, op, l->count, l->min, l->p50, l->p99,
+                   l->p999, l->max, mops, failed);
+            break;
+        default:
+            printf("%-9s %-9s %7d %6zu %-5s %9llu %6u %6u %7u %8u %9u %8.2f %6d\n", alloc, pattern, threads,
+                   size, op, l->count, l->min, l->p50, l->p99, l->p999, l->max, mops, failed);
+            break;
+    }
+}
+
+int benchmark_suite(const SuiteConfig* cfg) {
+    switch (cfg->output) {
+        case OUT_CSV:
+            printf("allocator,pattern,threads,block_size,op,count,min_ns,p50_ns,p99_ns,p999_ns,max_ns,mops,failed\n");
+            break;
+        case OUT_JSON:
+            printf("[\n");
+            break;
+        default:
+            printf("%-9s %-9s %7s %6s %-5s %9s %6s %6s %7s %8s %9s %8s %6s\n", "allocator", "pattern",
+                   "threads", "size", "op", "count", "min", "p50", "p99", "p99.9", "max", "Mops/s", "failed");
+            break;
+    }
+
+    int first = 1;
+    for (int ti = 0; ti < cfg->thread_count; ++ti) {
+        for (int si = 0; si < cfg->size_count; ++si) {
+            for (int pi = 0; pi < cfg->pattern_count; ++pi) {
+                for (int ai = 0; ai < cfg->alloc_count; ++ai) {
+                    SuitePattern pattern = (SuitePattern)cfg->patterns[pi];
+                    SuiteAllocKind kind = (SuiteAllocKind)cfg->allocs[ai];
+                    int threads = (int)cfg->threads[ti];
+                    size_t size = (size_t)cfg->sizes[si];
+                    SuiteResult r;
+                    if (suite_run(kind, pattern, threads, size, cfg->ops, &r) != 0) {
+                        fprintf(stderr, "skipped %s/%s with %d threads, %zu B\n",
+                                suite_alloc_name[kind], pattern_name[pattern], threads, size);
+                        continue;
+                    }
+                    if (pattern == PAT_PRODCONS) threads &= ~1;
+                    suite_print_row(cfg->output, first, suite_alloc_name[kind], pattern_name[pattern],
+                                    threads, size, "alloc", &r.alloc, r.mops, r.failed);
+                    suite_print_row(cfg->output, 0, suite_alloc_name[kind], pattern_name[pattern],
+                                    threads, size, "free", &r.free, r.mops, r.failed);
+                    fflush(stdout);
+                    first = 0;
+                }
+            }
+        }
+    }
+
+    if (cfg->output == OUT_JSON) {
+        printf("\n]\n");
+    }
+    return 0;
+}
+
+// Список чисел через запятую; возвращает количество или -1 при ошибке
+static int parse_number_list(const char* arg, long* values, int max) {
+    int count = 0;
+    const char* p = arg;
+    while (*p) {
+        char* end;
+        long value = strtol(p, &end, 10);
+        if (end == p || value <= 0 || count == max) return -1;
+        values[count++] = value;
+        p = *end == ',' ? end + 1 : end;
+        if (*end && *end != ',') return -1;
+    }
+    return count;
+}
+
+// Список имен через запятую; в indices — номера имен из names
+static int parse_name_list(const char* arg, const char* const* names, int name_count, int* indices) {
+    int count = 0;
+    char buffer[256];
+    snprintf(buffer, sizeof(buffer), "%s", arg);
+    for (char* token = strtok(buffer, ","); token; token = strtok(NULL, ",")) {
+        int found = -1;
+        for (int i = 0; i < name_count; ++i) {
+            if (strcmp(token, names[i]) == 0) found = i;
+        }
+        if (found < 0 || count == name_count) return -1;
+        indices[count++] = found;
+    }
+    return count;
+}
+
+static void usage(const char* prog) {
+    fprintf(stderr, "Usage: %s [-t threads [-s]] [-m] [-H] [-L] [-G] [-A] [-F] [-B] [-T] [-O] [-R]\n", prog);
+    fprintf(stderr, "       %s -S [-t threads,...] [-b sizes,...] [-p patterns] [-a allocators] [-n ops] [-o table|csv|json]\n", prog);
+    fprintf(stderr, "  -t N  multi-threaded mode: mutex pool vs lock-free pool vs magazine cache\n");
+    fprintf(stderr, "  -s    with -t: scaling table for 1, 2, 4, ... N threads\n");
+    fprintf(stderr, "  -m    mixed-size traffic: slab allocator vs malloc\n");
+    fprintf(stderr, "  -H    1M-block pool: startup time and dTLB misses, 4K vs huge pages\n");
+    fprintf(stderr, "  -L    1M-block pool: startup time and RSS, eager vs lazy free list\n");
+    fprintf(stderr, "  -G    growable pool: max alloc latency while a helper thread grows it\n");
+    fprintf(stderr, "  -A    per-cycle scratch memory: arena vs pool vs malloc\n");
+    fprintf(stderr, "  -F    false sharing and conflict misses with/without block alignment and coloring\n");
+    fprintf(stderr, "        (thread count from -t, default 4)\n");
+    fprintf(stderr, "  -B    bursts of blocks: per-block calls vs pool_alloc_n/pool_free_n\n");
+    fprintf(stderr, "        (thread count for the concurrent pool from -t, default 4)\n");
+    fprintf(stderr, "  -T    variable-size buffers: worst-case latency and memory overhead, malloc vs pool vs TLSF\n");
+    fprintf(stderr, "  -O    objects with expensive init: ctor/dtor per use vs object cache\n");
+    fprintf(stderr, "  -R    idle after a burst: RSS before/after pool_trim and fault-free pool_restore\n");
+    fprintf(stderr, "  -S    benchmark suite: min/p50/p99/p99.9/max alloc and free latency and throughput\n");
+    fprintf(stderr, "        -t  thread counts (default 1)          -b  block sizes (default %d)\n", BLOCK_SIZE);
+    fprintf(stderr, "        -p  lifo,fifo,random,prodcons,burst    -a  malloc,pool,lockfree,magazine,tlsf\n");
+    fprintf(stderr, "        -n  allocations per thread (default %d) -o  output format (default table)\n", SUITE_OPS);
+}
+
+int main(int argc, char* argv[]) {
+    int threads = 0;
+    int scaling = 0;
+    int mixed = 0;
+    int hugepages = 0;
+    int lazy = 0;
+    int growable = 0;
+    int cycle = 0;
+    int cache_layout = 0;
+    int burst = 0;
+    int tlsf = 0;
+    int objcache = 0;
+    int trim = 0;
+    int suite = 0;
+    SuiteConfig suite_cfg = { .ops = SUITE_OPS, .output = OUT_TABLE };
+    int opt;
+    while ((opt = getopt(argc, argv, "t:smHLGAFBTORSb:p:a:n:o:")) != -1) {
+        switch (opt) {
+            case 't':
+                threads = atoi(optarg);
+                suite_cfg.thread_count = parse_number_list(optarg, suite_cfg.threads, SUITE_MAX_VALUES);
+                if (suite_cfg.thread_count < 0) {
+                    usage(argv[0]);
+                    return 1;
+                }
+                break;
+            case 'S':
+                suite = 1;
+                break;
+            case 'b':
+                suite_cfg.size_count = parse_number_list(optarg, suite_cfg.sizes, SUITE_MAX_VALUES);
+                if (suite_cfg.size_count < 0) {
+                    usage(argv[0]);
+                    return 1;
+                }
+                break;
+            case 'p':
+                suite_cfg.pattern_count = parse_name_list(optarg, pattern_name, PAT_COUNT, suite_cfg.patterns);
+                if (suite_cfg.pattern_count < 0) {
+                    usage(argv[0]);
+                    return 1;
+                }
+                break;
+            case 'a':
+                suite_cfg.alloc_count = parse_name_list(optarg, suite_alloc_name, SA_COUNT, suite_cfg.allocs);
+                if (suite_cfg.alloc_count < 0) {
+                    usage(argv[0]);
+                    return 1;
+                }
+                break;
+            case 'n':
+                suite_cfg.ops = atoi(optarg);
+                if (suite_cfg.ops <= 0) {
+                    usage(argv[0]);
+                    return 1;
+                }
+                break;
+            case 'o':
+                if (strcmp(optarg, "csv") == 0) {
+                    suite_cfg.output = OUT_CSV;
+                } else if (strcmp(optarg, "json") == 0) {
+                    suite_cfg.output = OUT_JSON;
+                } else if (strcmp(optarg, "table") == 0) {
+                    suite_cfg.output = OUT_TABLE;
+                } else {
+                    usage(argv[0]);
+                    return 1;
+                }
+                break;
+            case 's':
+                scaling = 1;
+                break;
+            case 'm':
+                mixed = 1;
+                break;
+            case 'H':
+                hugepages = 1;
+                break;
+            case 'L':
+                lazy = 1;
+                break;
+            case 'G':
+                growable = 1;
+                break;
+            case 'A':
+                cycle = 1;
+                break;
+            case 'F':
+                cache_layout = 1;
+                break;
+            case 'B':
+                burst = 1;
+                break;
+            case 'T':
+                tlsf = 1;
+                break;
+            case 'O':
+                objcache = 1;
+                break;
+            case 'R':
+                trim = 1;
+                break;
+            default:
+                usage(argv[0]);
+                return 1;
+        }
+    }
+
+    // Для ленивого пула MCL_FUTURE не должен прогревать новые отображения целиком.
+    // В замерах RSS (-L, -R) куча не должна отдавать новому пулу страницы,
+    // оставшиеся резидентными от предыдущего прогона
+    RtMemOptions rt_opts = { .flags = (lazy ? RTMEM_LOCK_ONFAULT : 0) |
+                                      (lazy || trim ? RTMEM_KEEP_MALLOC : 0) };
+    if (rtmem_init(&rt_opts) != 0) {
         perror("mlockall failed. Try with sudo");
         return 1;
     }
 
+    if (mixed) {
+        benchmark_mixed();
+        return 0;
+    }
+
+    if (hugepages) {
+        benchmark_hugepages();
+        return 0;
+    }
+
+    if (lazy) {
+        benchmark_lazy();
+        return 0;
+    }
+
+    if (growable) {
+        benchmark_growable();
+        return 0;
+    }
+
+    if (cycle) {
+        benchmark_cycle();
+        return 0;
+    }
+
+    if (cache_layout) {
+        benchmark_cache_layout(threads > 0 ? threads : 4);
+        return 0;
+    }
+
+    if (suite) {
+        // Незаданные списки — значения по умолчанию
+        if (suite_cfg.thread_count == 0) {
+            suite_cfg.threads[suite_cfg.thread_count++] = 1;
+        }
+        if (suite_cfg.size_count == 0) {
+            suite_cfg.sizes[suite_cfg.size_count++] = BLOCK_SIZE;
+        }
+        if (suite_cfg.pattern_count == 0) {
+            for (int i = 0; i < PAT_COUNT; ++i) suite_cfg.patterns[suite_cfg.pattern_count++] = i;
+        }
+        if (suite_cfg.alloc_count == 0) {
+            for (int i = 0; i < SA_COUNT; ++i) suite_cfg.allocs[suite_cfg.alloc_count++] = i;
+        }
+        return benchmark_suite(&suite_cfg);
+    }
+
+    if (trim) {
+        benchmark_trim();
+        return 0;
+    }
+
+    if (objcache) {
+        benchmark_objcache();
+        return 0;
+    }
+
+    if (tlsf) {
+        benchmark_tlsf();
+        return 0;
+    }
+
+    if (burst) {
+        benchmark_burst(threads > 0 ? threads : 4);
+        return 0;
+    }
+
+    if (threads > 0) {
+        if (scaling) {
+            benchmark_mt_scaling(threads);
+        } else {
+            benchmark_mt_compare(threads);
+        }
+        return 0;
+    }
+
     benchmark_malloc();
     printf("\n");
     benchmark_mempool();
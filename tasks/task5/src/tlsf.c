@@ -0,0 +1,295 @@
+#define _GNU_SOURCE
+#include "tlsf.h"
+#include <stdint.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#define ALIGN_LOG2 4
+#define FL_SHIFT (TLSF_SL_LOG2 + ALIGN_LOG2)
+#define SMALL_BLOCK_SIZE ((size_t)1 << FL_SHIFT) // Меньшие блоки — линейно в первом списке
+#define FL_MAX 40                                 // Блоки меньше 2^40 байт
+#define FL_COUNT (FL_MAX - FL_SHIFT + 1)          // 32 — ровно одно слово fl_bitmap
+
+// Заголовок блока. prev_phys и size есть у каждого блока, ссылки списка —
+// только у свободного и лежат в его полезной части
+typedef struct Block {
+    struct Block* prev_phys; // Предыдущий по адресу блок (NULL у первого)
+    size_t size;             // Размер полезной части; младший бит — блок свободен
+    struct Block* next_free;
+    struct Block* prev_free;
+} Block;
+
+#define BLOCK_HEADER_SIZE (sizeof(Block*) + sizeof(size_t))
+#define BLOCK_MIN_SIZE (sizeof(Block) - BLOCK_HEADER_SIZE)
+#define BLOCK_FREE ((size_t)1)
+
+// Управляющая структура лежит в начале своей же области: tlsf_create() не
+// вызывает malloc и подходит для аллокатора, который сам подменяет malloc
+struct Tlsf {
+    char* start;
+    size_t mapped_size;
+    size_t max_size;      // Наибольший размер одного блока
+    size_t free_bytes;
+    uint32_t fl_bitmap;   // Бит fl — в sl_bitmap[fl] есть непустые списки
+    uint32_t sl_bitmap[FL_COUNT];
+    Block* blocks[FL_COUNT][TLSF_SL_COUNT];
+};
+
+#define CONTROL_SIZE ((sizeof(Tlsf) + TLSF_ALIGN - 1) & ~(size_t)(TLSF_ALIGN - 1))
+
+static inline size_t block_size(const Block* block) {
+    return block->size & ~BLOCK_FREE;
+}
+
+static inline int block_is_free(const Block* block) {
+    return (block->size & BLOCK_FREE) != 0;
+}
+
+static inline Block* block_next_phys(const Block* block) {
+    return (Block*)((char*)block + BLOCK_HEADER_SIZE + block_size(block));
+}
+
+static inline int fls_size(size_t x) {
+    return 63 - __builtin_clzll((unsigned long long)x);
+}
+
+// Номера списков, к которым относится блок размера size
+static inline void mapping_insert(size_t size, int* fl, int* sl) {
+    if (size < SMALL_BLOCK_SIZE) {
+        *fl = 0;
+        *sl = (int)(size / (SMALL_BLOCK_SIZE / TLSF_SL_COUNT));
+    } else {
+        int f = fls_size(size);
+        *sl = (int)((size >> (f - TLSF_SL_LOG2)) ^ ((size_t)1 << TLSF_SL_LOG2));
+        *fl = f - FL_SHIFT + 1;
+    }
+}
+
+// Округление запроса вверх до границы класса: тогда любой блок найденного
+// списка подходит, и список не нужно обходить
+static inline size_t mapping_round(size_t size) {
+    if (size >= SMALL_BLOCK_SIZE) {
+        size += ((size_t)1 << (fls_size(size) - TLSF_SL_LOG2)) - 1;
+    }
+    return size;
+}
+
+// Первый непустой список не меньше (fl, sl): два поиска младшего бита
+static inline Block* find_suitable(const Tlsf* tlsf, int* fl, int* sl) {
+    uint32_t sl_map = tlsf->sl_bitmap[*fl] & (~0u << *sl);
+    if (!sl_map) {
+        uint32_t fl_map = *fl + 1 < FL_COUNT ? tlsf->fl_bitmap & (~0u << (*fl + 1)) : 0;
+        if (!fl_map) {
+            return NULL;
+        }
+        *fl = __builtin_ctz(fl_map);
+        sl_map = tlsf->sl_bitmap[*fl];
+    }
+    *sl = __builtin_ctz(sl_map);
+    return tlsf->blocks[*fl][*sl];
+}
+
+static inline void remove_free(Tlsf* tlsf, Block* block) {
+    int fl, sl;
+    mapping_insert(block_size(block), &fl, &sl);
+    if (block->prev_free) {
+        block->prev_free->next_free = block->next_free;
+    } else {
+        tlsf->blocks[fl][sl] = block->next_free;
+        if (!block->next_free) {
+            tlsf->sl_bitmap[fl] &= ~(1u << sl);
+            if (!tlsf->sl_bitmap[fl]) {
+                tlsf->fl_bitmap &= ~(1u << fl);
+            }
+        }
+    }
+    if (block->next_free) {
+        block->next_free->prev_free = block->prev_free;
+    }
+    block->size &= ~BLOCK_FREE;
+    tlsf->free_bytes -= block_size(block);
+}
+
+static inline void insert_free(Tlsf* tlsf, Block* block) {
+    int fl, sl;
+    mapping_insert(block_size(block), &fl, &sl);
+    block->prev_free = NULL;
+    block->next_free = tlsf->blocks[fl][sl];
+    if (block->next_free) {
+        block->next_free->prev_free = block;
+    }
+    tlsf->blocks[fl][sl] = block;
+    tlsf->sl_bitmap[fl] |= 1u << sl;
+    tlsf->fl_bitmap |= 1u << fl;
+    block->size |= BLOCK_FREE;
+    tlsf->free_bytes += block_size(block);
+}
+
+Tlsf* tlsf_create(size_t capacity) {
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    if (capacity > ((size_t)1 << FL_MAX)) return NULL;
+    size_t mapped_size = (CONTROL_SIZE + capacity + page - 1) & ~(page - 1);
+    size_t area = mapped_size - CONTROL_SIZE;
+    // Один начальный блок и завершающий заголовок-ограничитель
+    if (area < 2 * BLOCK_HEADER_SIZE + BLOCK_MIN_SIZE ||
+        area - 2 * BLOCK_HEADER_SIZE >= ((size_t)1 << FL_MAX)) {
+        return NULL;
+    }
+
+    char* mem = mmap(NULL, mapped_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mem == MAP_FAILED) return NULL;
+
+    // Заблокировать область и прогреть каждую страницу до начала RT-цикла
+    mlock(mem, mapped_size);
+    for (size_t off = 0; off < mapped_size; off += page) {
+        ((volatile char*)mem)[off] = 0;
+    }
+
+    // Анонимная память уже обнулена: списки и битовые карты пусты
+    Tlsf* tlsf = (Tlsf*)mem;
+    tlsf->start = mem + CONTROL_SIZE;
+    tlsf->mapped_size = mapped_size;
+
+    Block* block = (Block*)tlsf->start;
+    block->prev_phys = NULL;
+    block->size = area - 2 * BLOCK_HEADER_SIZE;
+    tlsf->max_size = block->size;
+
+    // Ограничитель: занятый блок нулевого размера, с которым ничего не сливается
+    Block* sentinel = block_next_phys(block);
+    sentinel->prev_phys = block;
+    sentinel->size = 0;
+
+    insert_free(tlsf, block);
+    return tlsf;
+}
+
+// Размер полезной части под запрос size: кратен TLSF_ALIGN и не меньше минимального блока
+static inline size_t adjust_size(size_t size) {
+    size_t adjusted = (size + TLSF_ALIGN - 1) & ~(size_t)(TLSF_ALIGN - 1);
+    return adjusted < BLOCK_MIN_SIZE ? BLOCK_MIN_SIZE : adjusted;
+}
+
+// Свободный блок, в котором гарантированно помещается size байт, уже вынутый из списков
+static inline Block* take_block(Tlsf* tlsf, size_t size) {
+    size_t search = mapping_round(size);
+    if (search > tlsf->max_size) return NULL;
+
+    int fl, sl;
+    mapping_insert(search, &fl, &sl);
+    Block* block = find_suitable(tlsf, &fl, &sl);
+    if (block) {
+        remove_free(tlsf, block);
+    }
+    return block;
+}
+
+// Отделить остаток, если в нем помещается заголовок и минимальный блок
+static inline void split_tail(Tlsf* tlsf, Block* block, size_t adjusted) {
+    size_t size_found = block_size(block);
+    if (size_found >= adjusted + sizeof(Block)) {
+        Block* rest = (Block*)((char*)block + BLOCK_HEADER_SIZE + adjusted);
+        rest->prev_phys = block;
+        rest->size = size_found - adjusted - BLOCK_HEADER_SIZE;
+        block_next_phys(rest)->prev_phys = rest;
+        block->size = adjusted;
+        insert_free(tlsf, rest);
+    }
+}
+
+void* tlsf_alloc(Tlsf* tlsf, size_t size) {
+    if (!tlsf || size == 0 || size > tlsf->max_size) return NULL;
+
+    size_t adjusted = adjust_size(size);
+    Block* block = take_block(tlsf, adjusted);
+    if (!block) return NULL;
+    split_tail(tlsf, block, adjusted);
+    return (char*)block + BLOCK_HEADER_SIZE;
+}
+
+void* tlsf_alloc_aligned(Tlsf* tlsf, size_t align, size_t size) {
+    if (align <= TLSF_ALIGN) return tlsf_alloc(tlsf, size);
+    if (!tlsf || size == 0 || size > tlsf->max_size || (align & (align - 1)) != 0) return NULL;
+
+    // Запас на сдвиг до границы и на свободный блок, отделяемый перед ней
+    size_t adjusted = adjust_size(size);
+    if (adjusted + sizeof(Block) > tlsf->max_size || align > tlsf->max_size - adjusted - sizeof(Block)) return NULL;
+    Block* block = take_block(tlsf, adjusted + align + sizeof(Block));
+    if (!block) return NULL;
+
+    uintptr_t ptr = (uintptr_t)block + BLOCK_HEADER_SIZE;
+    uintptr_t aligned = (ptr + align - 1) & ~(uintptr_t)(align - 1);
+    if (aligned != ptr && aligned - ptr < sizeof(Block)) {
+        aligned = (ptr + sizeof(Block) + align - 1) & ~(uintptr_t)(align - 1);
+    }
+    size_t gap = aligned - ptr;
+    if (gap) {
+        // Начало блока до границы возвращается в списки отдельным свободным блоком.
+        // Его сосед слева занят: свободные блоки всегда слиты
+        Block* aligned_block = (Block*)(aligned - BLOCK_HEADER_SIZE);
+        aligned_block->prev_phys = block;
+        aligned_block->size = block_size(block) - gap;
+        block_next_phys(aligned_block)->prev_phys = aligned_block;
+        block->size = gap - BLOCK_HEADER_SIZE;
+        insert_free(tlsf, block);
+        block = aligned_block;
+    }
+    split_tail(tlsf, block, adjusted);
+    return (char*)block + BLOCK_HEADER_SIZE;
+}
+
+size_t tlsf_usable_size(const void* ptr) {
+    if (!ptr) return 0;
+    return block_size((const Block*)((const char*)ptr - BLOCK_HEADER_SIZE));
+}
+
+int tlsf_owns(const Tlsf* tlsf, const void* ptr) {
+    return tlsf && (const char*)ptr >= tlsf->start &&
+           (const char*)ptr < (const char*)tlsf + tlsf->mapped_size;
+}
+
+void tlsf_free(Tlsf* tlsf, void* ptr) {
+    if (!tlsf || !ptr) return;
+
+    Block* block = (Block*)((char*)ptr - BLOCK_HEADER_SIZE);
+
+    // Слить с соседями по памяти, если они свободны
+    Block* prev = block->prev_phys;
+    if (prev && block_is_free(prev)) {
+        remove_free(tlsf, prev);
+        prev->size = block_size(prev) + BLOCK_HEADER_SIZE + block_size(block);
+        block = prev;
+        block_next_phys(block)->prev_phys = block;
+    }
+    Block* next = block_next_phys(block);
+    if (block_is_free(next)) {
+        remove_free(tlsf, next);
+        block->size = block_size(block) + BLOCK_HEADER_SIZE + block_size(next);
+        block_next_phys(block)->prev_phys = block;
+    }
+    insert_free(tlsf, block);
+}
+
+size_t tlsf_free_bytes(const Tlsf* tlsf) {
+    return tlsf ? tlsf->free_bytes : 0;
+}
+
+size_t tlsf_largest_free(const Tlsf* tlsf) {
+    if (!tlsf || !tlsf->fl_bitmap) return 0;
+    int fl = 31 - __builtin_clz(tlsf->fl_bitmap);
+    int sl = 31 - __builtin_clz(tlsf->sl_bitmap[fl]);
+    size_t largest = 0;
+    for (const Block* block = tlsf->blocks[fl][sl]; block; block = block->next_free) {
+        if (block_size(block) > largest) {
+            largest = block_size(block);
+        }
+    }
+    return largest;
+}
+
+void tlsf_destroy(Tlsf* tlsf) {
+    if (!tlsf) return;
+    size_t mapped_size = tlsf->mapped_size;
+    munlock(tlsf, mapped_size);
+    munmap(tlsf, mapped_size);
+}
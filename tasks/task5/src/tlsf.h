@@ -0,0 +1,111 @@
+#ifndef TLSF_H
+#define TLSF_H
+
+#include <stddef.h>
+
+/*
+ * TLSF (two-level segregated fit) — аллокатор блоков произвольного размера
+ * с ограниченным временем выделения и освобождения.
+ *
+ * Свободные блоки разложены по спискам двух уровней: первый уровень — степень
+ * двойки размера, второй делит этот диапазон на TLSF_SL_COUNT равных частей.
+ * Подходящий список находится по двум битовым картам за несколько инструкций
+ * (поиск первого установленного бита), поэтому tlsf_alloc() и tlsf_free() —
+ * O(1) без обхода списков. При освобождении блок сразу сливается с соседями
+ * по памяти, что держит внешнюю фрагментацию низкой.
+ *
+ * Вся память берется из одной области, которая блокируется и прогревается
+ * в tlsf_create(). Управляющая структура лежит в той же области, поэтому
+ * аллокатор не зависит от malloc и годится для его подмены (rtmalloc.h).
+ */
+
+/** Log2 числа списков второго уровня. */
+#define TLSF_SL_LOG2 5
+/** Число списков второго уровня на каждый список первого уровня. */
+#define TLSF_SL_COUNT (1 << TLSF_SL_LOG2)
+/** Выравнивание возвращаемых указателей и шаг размеров блоков. */
+#define TLSF_ALIGN 16
+
+typedef struct Tlsf Tlsf;
+
+/**
+ * @brief Создает аллокатор над заблокированной и прогретой областью.
+ *
+ * @param capacity Размер области в байтах.
+ * @return Указатель на аллокатор или NULL в случае ошибки.
+ */
+Tlsf* tlsf_create(size_t capacity);
+
+/**
+ * @brief Выделяет size байт (с выравниванием TLSF_ALIGN) за O(1).
+ *
+ * @param tlsf Указатель на аллокатор.
+ * @param size Размер в байтах.
+ * @return Указатель на память или NULL, если подходящего свободного блока нет.
+ */
+void* tlsf_alloc(Tlsf* tlsf, size_t size);
+
+/**
+ * @brief Выделяет size байт с выравниванием align за O(1).
+ *
+ * Блок ищется с запасом на выравнивание, часть перед границей возвращается
+ * в списки свободным блоком.
+ *
+ * @param tlsf Указатель на аллокатор.
+ * @param align Выравнивание (степень двойки).
+ * @param size Размер в байтах.
+ * @return Указатель на память или NULL, если подходящего свободного блока нет.
+ */
+void* tlsf_alloc_aligned(Tlsf* tlsf, size_t align, size_t size);
+
+/**
+ * @brief Освобождает память, выделенную tlsf_alloc() или tlsf_alloc_aligned(), за O(1).
+ *
+ * @param tlsf Указатель на аллокатор.
+ * @param ptr Указатель на память (NULL игнорируется).
+ */
+void tlsf_free(Tlsf* tlsf, void* ptr);
+
+/**
+ * @brief Возвращает размер полезной части блока (не меньше запрошенного).
+ *
+ * @param ptr Указатель, полученный от tlsf_alloc() или tlsf_alloc_aligned().
+ * @return Размер в байтах (0 для NULL).
+ */
+size_t tlsf_usable_size(const void* ptr);
+
+/**
+ * @brief Проверяет, выделен ли указатель из области аллокатора.
+ *
+ * @param tlsf Указатель на аллокатор.
+ * @param ptr Проверяемый указатель.
+ * @return 1, если ptr лежит в области аллокатора, иначе 0.
+ */
+int tlsf_owns(const Tlsf* tlsf, const void* ptr);
+
+/**
+ * @brief Возвращает суммарный размер свободных блоков.
+ *
+ * @param tlsf Указатель на аллокатор.
+ * @return Свободные байты (без заголовков блоков).
+ */
+size_t tlsf_free_bytes(const Tlsf* tlsf);
+
+/**
+ * @brief Возвращает размер наибольшего свободного блока.
+ *
+ * Обходит список старшего непустого класса — только для статистики, не для RT-пути.
+ *
+ * @param tlsf Указатель на аллокатор.
+ * @return Размер наибольшего свободного блока в байтах.
+ */
+size_t tlsf_largest_free(const Tlsf* tlsf);
+
+/**
+ * @brief Уничтожает аллокатор и освобождает область.
+ *
+ * @param tlsf Указатель на аллокатор.
+ */
+void tlsf_destroy(Tlsf* tlsf);
+
+#endif // TLSF_H
@@ -0,0 +1,233 @@
+#define _GNU_SOURCE
+#include "uffdpop.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/userfaultfd.h>
+
+#ifndef UFFD_USER_MODE_ONLY
+#define UFFD_USER_MODE_ONLY 1
+#endif
+#ifndef MLOCK_ONFAULT
+#define MLOCK_ONFAULT 1
+#endif
+
+struct UffdRegion {
+    char* base;
+    size_t size;
+    size_t window;
+    size_t page;
+    unsigned flags;
+    int uffd;
+    int stop_fd;        // eventfd остановки потока-обработчика
+    char* zero;         // Источник для UFFDIO_COPY: window байт нулей
+    pthread_t handler;
+    atomic_ullong faults;
+    atomic_ullong pages;
+    atomic_ullong max_wake_ns;
+    atomic_ullong errors;
+};
+
+// Заполняет [start, end). wake = 0 — не будить потоки, ждущие этих страниц.
+// Возвращает число заполненных страниц; уже заполненные пропускаются.
+// error — код ошибки, на которой заполнение остановилось (0, если дошло до end)
+static size_t populate(UffdRegion* r, uintptr_t start, uintptr_t end, int wake, int* error) {
+    size_t pages = 0;
+    *error = 0;
+    while (start < end) {
+        size_t len = end - start;
+        long long done;
+        int rc;
+        if (r->flags & UFFD_POP_ZEROPAGE) {
+            struct uffdio_zeropage zp = {
+                .range = {.start = start, .len = len},
+                .mode = wake ? 0 : UFFDIO_ZEROPAGE_MODE_DONTWAKE,
+            };
+            rc = ioctl(r->uffd, UFFDIO_ZEROPAGE, &zp);
+            done = zp.zeropage;
+        } else {
+            if (len > r->window) len = r->window;
+            struct uffdio_copy copy = {
+                .dst = start,
+                .src = (uintptr_t)r->zero,
+                .len = len,
+                .mode = wake ? 0 : UFFDIO_COPY_MODE_DONTWAKE,
+            };
+            rc = ioctl(r->uffd, UFFDIO_COPY, &copy);
+            done = copy.copy;
+        }
+        if (rc == 0) {
+            pages += len / r->page;
+            start += len;
+        } else if (done > 0) {
+            // Частичное заполнение: продолжить с первой незаполненной страницы
+            pages += (size_t)done / r->page;
+            start += (size_t)done;
+        } else if (done == -EEXIST) {
+            start += r->page;
+        } else if (done != -EAGAIN) {
+            *error = done < 0 ? (int)-done : errno;
+            break;
+        }
+    }
+    return pages;
+}
+
+static void* uffd_handler(void* arg) {
+    UffdRegion* r = (UffdRegion*)arg;
+    uintptr_t region_end = (uintptr_t)r->base + r->size;
+    struct pollfd fds[2] = {{.fd = r->uffd, .events = POLLIN}, {.fd = r->stop_fd, .events = POLLIN}};
+
+    for (;;) {
+        if (poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        if (fds[1].revents) break;
+
+        struct uffd_msg msg;
+        if (read(r->uffd, &msg, sizeof(msg)) != (ssize_t)sizeof(msg)) continue;
+        if (msg.event != UFFD_EVENT_PAGEFAULT) continue;
+
+        struct timespec start, end;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        uintptr_t addr = (uintptr_t)msg.arg.pagefault.address & ~(uintptr_t)(r->page - 1);
+
+        // Сначала страница промаха, чтобы поток продолжил работу как можно раньше
+        int error;
+        size_t pages = populate(r, addr, addr + r->page, 1, &error);
+        if (error) {
+            // Страница не заполнена (ENOMEM и т.п.): разбудить поток без нее значило бы
+            // получить тот же промах снова. Снятие регистрации будит ждущие потоки, и
+            // дальше отказы в области обслуживает ядро обычным образом
+            atomic_fetch_add_explicit(&r->errors, 1, memory_order_relaxed);
+            struct uffdio_range range = {.start = (uintptr_t)r->base, .len = r->size};
+            ioctl(r->uffd, UFFDIO_UNREGISTER, &range);
+            break;
+        }
+        if (pages == 0) {
+            // Страницу уже заполнило окно предыдущего промаха (EEXIST), но поток ждет пробуждения
+            struct uffdio_range range = {.start = addr, .len = r->page};
+            ioctl(r->uffd, UFFDIO_WAKE, &range);
+        }
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        unsigned long long wake_ns = (unsigned long long)((end.tv_sec - start.tv_sec) * 1000000000LL +
+                                                          (end.tv_nsec - start.tv_nsec));
+        if (wake_ns > atomic_load_explicit(&r->max_wake_ns, memory_order_relaxed)) {
+            atomic_store_explicit(&r->max_wake_ns, wake_ns, memory_order_relaxed);
+        }
+
+        // Затем окно вперед, пока поток уже работает
+        uintptr_t window_end = addr + r->window;
+        if (window_end > region_end || window_end < addr) window_end = region_end;
+        // Ошибка в окне не страшна: недозаполненные страницы дадут свои промахи позже
+        if (addr + r->page < window_end) pages += populate(r, addr + r->page, window_end, 0, &error);
+
+        atomic_fetch_add_explicit(&r->faults, 1, memory_order_relaxed);
+        atomic_fetch_add_explicit(&r->pages, pages, memory_order_relaxed);
+    }
+    return NULL;
+}
+
+UffdRegion* uffd_region_create(size_t size, size_t window, unsigned flags) {
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size = (size + page - 1) & ~(page - 1);
+    window = (window + page - 1) & ~(page - 1);
+    if (window == 0) window = page;
+    if (size == 0) return NULL;
+
+    UffdRegion* r = (UffdRegion*)calloc(1, sizeof(UffdRegion));
+    if (!r) return NULL;
+    r->size = size;
+    r->window = window;
+    r->page = page;
+    r->flags = flags;
+    r->uffd = -1;
+    r->stop_fd = -1;
+    atomic_init(&r->faults, 0);
+    atomic_init(&r->pages, 0);
+    atomic_init(&r->max_wake_ns, 0);
+    atomic_init(&r->errors, 0);
+
+    // UFFD_USER_MODE_ONLY (Linux 5.11+) разрешен и при vm.unprivileged_userfaultfd = 0
+    r->uffd = (int)syscall(SYS_userfaultfd, O_CLOEXEC | O_NONBLOCK | UFFD_USER_MODE_ONLY);
+    if (r->uffd < 0 && errno == EINVAL) {
+        r->uffd = (int)syscall(SYS_userfaultfd, O_CLOEXEC | O_NONBLOCK);
+    }
+    if (r->uffd < 0) goto fail;
+
+    struct uffdio_api api = {.api = UFFD_API, .features = 0};
+    if (ioctl(r->uffd, UFFDIO_API, &api) != 0) goto fail;
+
+    r->base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (r->base == MAP_FAILED) {
+        r->base = NULL;
+        goto fail;
+    }
+    // Страницы, заполненные обработчиком, сразу попадают под блокировку
+    mlock2(r->base, size, MLOCK_ONFAULT);
+
+    if (!(flags & UFFD_POP_ZEROPAGE)) {
+        r->zero = mmap(NULL, window, PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (r->zero == MAP_FAILED) {
+            r->zero = NULL;
+            goto fail;
+        }
+    }
+
+    struct uffdio_register reg = {
+        .range = {.start = (uintptr_t)r->base, .len = size},
+        .mode = UFFDIO_REGISTER_MODE_MISSING,
+    };
+    if (ioctl(r->uffd, UFFDIO_REGISTER, &reg) != 0) goto fail;
+    uint64_t needed = (flags & UFFD_POP_ZEROPAGE) ? (1ULL << _UFFDIO_ZEROPAGE) : (1ULL << _UFFDIO_COPY);
+    if ((reg.ioctls & needed) != needed) goto fail;
+
+    r->stop_fd = eventfd(0, EFD_CLOEXEC);
+    if (r->stop_fd < 0) goto fail;
+    if (pthread_create(&r->handler, NULL, uffd_handler, r) != 0) goto fail;
+    return r;
+
+fail:
+    if (r->stop_fd >= 0) close(r->stop_fd);
+    if (r->zero) munmap(r->zero, window);
+    if (r->base) munmap(r->base, size);
+    if (r->uffd >= 0) close(r->uffd);
+    free(r);
+    return NULL;
+}
+
+void* uffd_region_base(UffdRegion* region) {
+    return region->base;
+}
+
+void uffd_region_stats(UffdRegion* region, UffdStats* stats) {
+    stats->faults = atomic_load_explicit(&region->faults, memory_order_relaxed);
+    stats->pages = atomic_load_explicit(&region->pages, memory_order_relaxed);
+    stats->max_wake_ns = atomic_load_explicit(&region->max_wake_ns, memory_order_relaxed);
+    stats->errors = atomic_load_explicit(&region->errors, memory_order_relaxed);
+}
+
+void uffd_region_destroy(UffdRegion* region) {
+    if (!region) return;
+    uint64_t one = 1;
+    if (write(region->stop_fd, &one, sizeof(one)) == (ssize_t)sizeof(one)) {
+        pthread_join(region->handler, NULL);
+    }
+    close(region->stop_fd);
+    close(region->uffd);
+    if (region->zero) munmap(region->zero, region->window);
+    munmap(region->base, region->size);
+    free(region);
+}
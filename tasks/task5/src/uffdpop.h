@@ -0,0 +1,80 @@
+#ifndef UFFDPOP_H
+#define UFFDPOP_H
+
+#include <stddef.h>
+
+/*
+ * Экспериментальное заполнение большой области через userfaultfd.
+ *
+ * Заполнить многогигабайтную область заранее слишком долго, а отказы при
+ * первом касании в RT-цикле недопустимы. uffd_region_create() отображает
+ * область без заполнения и регистрирует ее в userfaultfd (режим MISSING).
+ * Отказы обслуживает отдельный поток. На каждый промах он сначала заполняет
+ * страницу, к которой было обращение, и сразу будит поток, получивший отказ.
+ * Затем он заполняет окно window байт вперед (UFFDIO_COPY из нулевого
+ * буфера или UFFDIO_ZEROPAGE), пока RT-поток уже работает дальше. При
+ * последовательном обходе один промах приходится на окно, а не на страницу.
+ *
+ * Если страницу промаха заполнить не удалось (например, ENOMEM), обработчик
+ * снимает регистрацию области и завершается: ждущий поток просыпается, и
+ * дальше отказы в области обслуживает ядро как в обычном отображении.
+ *
+ * Отказ, обслуженный через userfaultfd, дороже обычного: два переключения
+ * контекста вместо одного. Режим выгоден, когда окно покрывает много страниц.
+ *
+ * Область блокируется через mlock2(MLOCK_ONFAULT), поэтому заполненные
+ * обработчиком страницы сразу заблокированы. mlockall(MCL_FUTURE) без
+ * MCL_ONFAULT заполнил бы ее целиком еще в mmap, и смысл режима пропал бы.
+ */
+
+/** Флаги uffd_region_create(). */
+enum {
+    /** Заполнять окно разделяемой нулевой страницей (UFFDIO_ZEROPAGE). Не тратит
+     *  память, но первая запись в такую страницу еще вызывает copy-on-write отказ;
+     *  подходит для областей, которые в основном читаются. */
+    UFFD_POP_ZEROPAGE = 1u << 0,
+};
+
+typedef struct UffdRegion UffdRegion;
+
+/** Счетчики потока-обработчика. */
+typedef struct {
+    unsigned long long faults;      ///< Обслужено промахов.
+    unsigned long long pages;       ///< Заполнено страниц (с окнами).
+    unsigned long long max_wake_ns; ///< Наибольшее время от чтения события до пробуждения потока.
+    unsigned long long errors;      ///< Промахов, которые не удалось заполнить (после первого
+                                    ///< обработчик снимает регистрацию и завершается).
+} UffdStats;
+
+/**
+ * @brief Отображает область и запускает поток, обслуживающий ее промахи.
+ *
+ * @param size Размер области в байтах.
+ * @param window Сколько байт заполнять от страницы промаха (0 — одна страница).
+ * @param flags Комбинация флагов UFFD_POP_*.
+ * @return Указатель на область или NULL, если userfaultfd недоступен
+ *         (vm.unprivileged_userfaultfd, seccomp, ядро без CONFIG_USERFAULTFD).
+ */
+UffdRegion* uffd_region_create(size_t size, size_t window, unsigned flags);
+
+/**
+ * @brief Возвращает начало области.
+ */
+void* uffd_region_base(UffdRegion* region);
+
+/**
+ * @brief Возвращает счетчики потока-обработчика.
+ *
+ * @param region Указатель на область.
+ * @param stats Куда записать счетчики.
+ */
+void uffd_region_stats(UffdRegion* region, UffdStats* stats);
+
+/**
+ * @brief Останавливает поток-обработчик и освобождает область.
+ *
+ * @param region Указатель на область (NULL игнорируется).
+ */
+void uffd_region_destroy(UffdRegion* region);
+
+#endif // UFFDPOP_H
@@ -0,0 +1,35 @@
+#include "hotcode.h"
+
+#define HOTCODE_STEP 1031 // Простой шаг обхода: соседние вызовы попадают на далекие страницы
+
+typedef double (*HotFn)(double);
+
+// Функции генерируются макросами: H1024(0) и H1024(1) дают 2 * 4^5 функций
+#define HOT_FN(n) \
+    static __attribute__((noinline, aligned(4096))) double hot_##n(double x) { return x * 0.999999 + (double)(n); }
+#define H1(n) HOT_FN(n)
+#define H4(n) H1(n##0) H1(n##1) H1(n##2) H1(n##3)
+#define H16(n) H4(n##0) H4(n##1) H4(n##2) H4(n##3)
+#define H64(n) H16(n##0) H16(n##1) H16(n##2) H16(n##3)
+#define H256(n) H64(n##0) H64(n##1) H64(n##2) H64(n##3)
+#define H1024(n) H256(n##0) H256(n##1) H256(n##2) H256(n##3)
+
+H1024(0)
+H1024(1)
+
+#undef H1
+#define H1(n) hot_##n,
+
+static const HotFn hot_table[HOTCODE_FUNCS] = {
+    H1024(0)
+    H1024(1)
+};
+
+double hotcode_run(double x) {
+    unsigned idx = 0;
+    for (int i = 0; i < HOTCODE_FUNCS; ++i) {
+        x = hot_table[idx](x);
+        idx = (idx + HOTCODE_STEP) % HOTCODE_FUNCS;
+    }
+    return x;
+}
@@ -0,0 +1,25 @@
+#ifndef HOTCODE_H
+#define HOTCODE_H
+
+/*
+ * Рабочая нагрузка с большим объемом кода для замера промахов iTLB.
+ *
+ * HOTCODE_FUNCS маленьких функций, каждая на собственной 4K странице
+ * (всего 8 МБ кода). hotcode_run() вызывает их все в перемешанном порядке,
+ * так что каждый вызов обращается к новой странице кода. На 4K страницах
+ * такой обход не помещается в iTLB, а на huge pages занимает всего
+ * несколько записей.
+ */
+
+/** Число функций, каждая на своей странице. */
+#define HOTCODE_FUNCS 2048
+
+/**
+ * @brief Вызывает все функции нагрузки по одному разу.
+ *
+ * @param x Начальное значение.
+ * @return Результат цепочки вызовов (чтобы компилятор не убрал их).
+ */
+double hotcode_run(double x);
+
+#endif // HOTCODE_H
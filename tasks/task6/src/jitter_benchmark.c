@@ -1,31 +1,379 @@
 #define _GNU_SOURCE
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
 #include <time.h>
 #include <sched.h>
-#include <math.h>
+#include <pthread.h>
+#include <sys/ioctl.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#ifdef JITTER_ITLB
+#include "hotcode.h"
+#endif
+#include "hugetext.h"
+#include "memaudit.h"
+#include "rtmem.h"
+#include "workloads.h"
 
 #define NUM_ITERATIONS 1000
+#define CORE_STACK_SIZE (256 * 1024)     // Стек потока замера в режиме матрицы
+#define CORE_STACK_PREFAULT (64 * 1024)
+
+// Замер iTLB (-I) есть только в сборке jitter_itlb: ее код занимает 8 МБ
+#ifdef JITTER_ITLB
+#define ITLB_USAGE " [-I]"
+#else
+#define ITLB_USAGE ""
+#endif
+
+typedef struct {
+    long long min;
+    long long max;
+    long long p99;
+    double avg;
+} LatencyStats;
 
 long long timespec_diff_ns(struct timespec start, struct timespec end) {
     return (end.tv_sec - start.tv_sec) * 1000000000LL + (end.tv_nsec - start.tv_nsec);
 }
 
-void work_function() {
-    double result = 0.0;
-    for (int i = 0; i < 100000; ++i) {
-        result += sin(i) * cos(i);
+#ifdef JITTER_ITLB
+static volatile double hot_sink = 1.0;
+
+// Нагрузка с большим объемом кода: каждый вызов уходит на новую 4K страницу
+void hot_work_function(void* ctx) {
+    (void)ctx;
+    hot_sink = hotcode_run(hot_sink);
+}
+#endif
+
+static int compare_ll(const void* a, const void* b) {
+    long long x = *(const long long*)a, y = *(const long long*)b;
+    return (x > y) - (x < y);
+}
+
+// Замер NUM_ITERATIONS вызовов work(ctx); latencies после вызова отсортированы
+void run_loop(void (*work)(void*), void* ctx, long long* latencies, LatencyStats* stats) {
+    long long total = 0;
+    for (int i = 0; i < NUM_ITERATIONS; ++i) {
+        struct timespec start, end;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+
+        work(ctx);
+
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        latencies[i] = timespec_diff_ns(start, end);
+        total += latencies[i];
+    }
+    qsort(latencies, NUM_ITERATIONS, sizeof(long long), compare_ll);
+    stats->min = latencies[0];
+    stats->max = latencies[NUM_ITERATIONS - 1];
+    stats->p99 = latencies[NUM_ITERATIONS * 99 / 100];
+    stats->avg = (double)total / NUM_ITERATIONS;
+}
+
+#ifdef JITTER_ITLB
+// Счетчик промахов iTLB (perf_event_open), -1 если недоступен
+static int perf_open_itlb_misses(void) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HW_CACHE;
+    attr.config = PERF_COUNT_HW_CACHE_ITLB |
+                  (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                  (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+void itlb_run(const char* name, long long* latencies) {
+    LatencyStats stats;
+    int fd = perf_open_itlb_misses();
+    if (fd >= 0) {
+        ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+    run_loop(hot_work_function, NULL, latencies, &stats);
+    long long misses = -1;
+    if (fd >= 0) {
+        ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+        if (read(fd, &misses, sizeof(misses)) != sizeof(misses)) misses = -1;
+        close(fd);
+    }
+
+    printf("%-10s min %8lld ns, avg %10.1f ns, p99 %8lld ns, max %8lld ns, ",
+           name, stats.min, stats.avg, stats.p99, stats.max);
+    if (misses >= 0) {
+        printf("iTLB misses %lld\n", misses);
+    } else {
+        printf("iTLB misses n/a (perf_event_open unavailable)\n");
+    }
+}
+
+// Сравнение одной и той же нагрузки до и после переноса кода на huge pages
+void benchmark_itlb(long long* latencies) {
+    printf("Benchmarking %d iterations x %d calls, one 4K page of code each: 4K text vs huge text...\n",
+           NUM_ITERATIONS, HOTCODE_FUNCS);
+    hot_work_function(NULL); // Прогрев: первые обращения к коду не должны попасть в замер
+    itlb_run("4K text", latencies);
+
+    HugeTextInfo info;
+    if (hugetext_remap(&info) != 0) {
+        perror("hugetext_remap failed");
+        return;
+    }
+    if (info.remap_start == info.remap_end) {
+        printf("Text %#lx-%#lx has no aligned 2 MB range, nothing to remap\n",
+               (unsigned long)info.text_start, (unsigned long)info.text_end);
+        return;
+    }
+    printf("Text %#lx-%#lx remapped (%#lx-%#lx, %s, %zu KB on huge pages)\n",
+           (unsigned long)info.text_start, (unsigned long)info.text_end,
+           (unsigned long)info.remap_start, (unsigned long)info.remap_end,
+           hugetext_backing_name(info.backing), info.huge_bytes / 1024);
+    hot_work_function(NULL);
+    itlb_run("huge text", latencies);
+}
+#endif // JITTER_ITLB
+
+// Состояние нагрузки (NULL, если оно ей не нужно). Возвращает -1 при нехватке памяти
+static int workload_setup(const Workload* workload, size_t working_set, void** ctx) {
+    *ctx = workload->create ? workload->create(working_set) : NULL;
+    if (workload->create && !*ctx) {
+        fprintf(stderr, "Failed to allocate %zu KB for workload %s\n", working_set / 1024, workload->name);
+        return -1;
+    }
+    return 0;
+}
+
+static void workload_teardown(const Workload* workload, void* ctx) {
+    if (workload->destroy) workload->destroy(ctx);
+}
+
+// Замер каждой нагрузки по очереди в текущем потоке
+int benchmark_workloads(const Workload** selected, int count, size_t working_set, long long* latencies) {
+    printf("Benchmarking %d workload(s), working set %zu KB...\n", count, working_set / 1024);
+    printf("\n%-8s %10s %12s %10s %10s %10s %8s\n",
+           "Kernel", "min ns", "avg ns", "p99 ns", "max ns", "jitter ns", "faults");
+    int failed = 0;
+    for (int i = 0; i < count; ++i) {
+        void* ctx;
+        if (workload_setup(selected[i], working_set, &ctx) != 0) {
+            failed = 1;
+            continue;
+        }
+        selected[i]->run(ctx); // Прогрев кэшей и TLB до замера
+
+        LatencyStats stats;
+        struct rusage usage_before, usage_after;
+        getrusage(RUSAGE_SELF, &usage_before);
+        run_loop(selected[i]->run, ctx, latencies, &stats);
+        getrusage(RUSAGE_SELF, &usage_after);
+        printf("%-8s %10lld %12.1f %10lld %10lld %10lld %8ld\n",
+               selected[i]->name, stats.min, stats.avg, stats.p99, stats.max, stats.max - stats.min,
+               usage_after.ru_minflt - usage_before.ru_minflt + usage_after.ru_majflt - usage_before.ru_majflt);
+        workload_teardown(selected[i], ctx);
+    }
+    return failed;
+}
+
+typedef struct {
+    int cpu;
+    pthread_rwlock_t* gate; // Общий старт в параллельном режиме (NULL — последовательный)
+    const Workload* workload;
+    size_t working_set;
+    long long* latencies;
+    LatencyStats stats;
+    int ok;
+} CoreWorker;
+
+static void* core_worker(void* arg) {
+    CoreWorker* w = (CoreWorker*)arg;
+    rtmem_prefault_stack(CORE_STACK_PREFAULT);
+    // Буферы нагрузки выделяет и прогревает сам поток: страницы оказываются на узле NUMA его ядра
+    void* ctx;
+    int ready = workload_setup(w->workload, w->working_set, &ctx) == 0;
+    if (ready) w->workload->run(ctx); // Прогрев кэшей ядра до замера
+    if (w->gate) {
+        // Главный поток держит блокировку на запись, пока не созданы все потоки
+        pthread_rwlock_rdlock(w->gate);
+        pthread_rwlock_unlock(w->gate);
     }
+    if (!ready) return NULL;
+    run_loop(w->workload->run, ctx, w->latencies, &w->stats);
+    workload_teardown(w->workload, ctx);
+    w->ok = 1;
+    return NULL;
+}
+
+// Самые тихие ядра — с наименьшим p99, при равенстве — с наименьшим max
+static int compare_quiet(const void* a, const void* b) {
+    const CoreWorker* x = *(const CoreWorker* const*)a;
+    const CoreWorker* y = *(const CoreWorker* const*)b;
+    if (x->stats.p99 != y->stats.p99) return (x->stats.p99 > y->stats.p99) - (x->stats.p99 < y->stats.p99);
+    return (x->stats.max > y->stats.max) - (x->stats.max < y->stats.max);
+}
+
+// Замер на каждом доступном процессу CPU: потоком на ядро, одновременно или по очереди
+int benchmark_matrix(int parallel, const Workload* workload, size_t working_set) {
+    cpu_set_t allowed;
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) == -1) {
+        perror("sched_getaffinity failed");
+        return 1;
+    }
+    int count = CPU_COUNT(&allowed);
+    CoreWorker* workers = calloc((size_t)count, sizeof(CoreWorker));
+    CoreWorker** ranked = calloc((size_t)count, sizeof(CoreWorker*));
+    pthread_t* tids = calloc((size_t)count, sizeof(pthread_t));
+    long long* latencies = calloc((size_t)count * NUM_ITERATIONS, sizeof(long long));
+    if (!workers || !ranked || !tids || !latencies) {
+        printf("Failed to allocate per-CPU buffers\n");
+        free(workers);
+        free(ranked);
+        free(tids);
+        free(latencies);
+        return 1;
+    }
+
+    pthread_rwlock_t gate;
+    pthread_rwlock_init(&gate, NULL);
+    if (parallel) pthread_rwlock_wrlock(&gate);
+
+    printf("Benchmarking %d CPUs %s, workload %s...\n",
+           count, parallel ? "simultaneously" : "one after another", workload->name);
+    int n = 0;
+    for (int cpu = 0; cpu < CPU_SETSIZE && n < count; ++cpu) {
+        if (!CPU_ISSET(cpu, &allowed)) continue;
+        CoreWorker* w = &workers[n];
+        w->cpu = cpu;
+        w->gate = parallel ? &gate : NULL;
+        w->workload = workload;
+        w->working_set = working_set;
+        w->latencies = latencies + (size_t)n * NUM_ITERATIONS;
+
+        // Поток привязывается к ядру до старта и наследует SCHED_FIFO главного потока
+        cpu_set_t mask;
+        CPU_ZERO(&mask);
+        CPU_SET(cpu, &mask);
+        pthread_attr_t attr;
+        pthread_attr_init(&attr);
+        pthread_attr_setaffinity_np(&attr, sizeof(mask), &mask);
+        int rc = pthread_create(&tids[n], &attr, core_worker, w);
+        pthread_attr_destroy(&attr);
+        if (rc != 0) {
+            fprintf(stderr, "pthread_create for CPU %d failed: %s\n", cpu, strerror(rc));
+            continue;
+        }
+        if (!parallel) pthread_join(tids[n], NULL);
+        ++n;
+    }
+    if (parallel) {
+        pthread_rwlock_unlock(&gate);
+        for (int i = 0; i < n; ++i) pthread_join(tids[i], NULL);
+    }
+    pthread_rwlock_destroy(&gate);
+
+    printf("\n%-5s %10s %12s %10s %10s %10s\n", "CPU", "min ns", "avg ns", "p99 ns", "max ns", "jitter ns");
+    int measured = 0;
+    for (int i = 0; i < n; ++i) {
+        CoreWorker* w = &workers[i];
+        if (!w->ok) continue;
+        printf("%-5d %10lld %12.1f %10lld %10lld %10lld\n",
+               w->cpu, w->stats.min, w->stats.avg, w->stats.p99, w->stats.max, w->stats.max - w->stats.min);
+        ranked[measured++] = w;
+    }
+    qsort(ranked, (size_t)measured, sizeof(CoreWorker*), compare_quiet);
+    printf("\nQuietest cores (by p99, then max):");
+    for (int i = 0; i < measured; ++i) printf(" %d", ranked[i]->cpu);
+    printf("\n");
+
+    free(workers);
+    free(ranked);
+    free(tids);
+    free(latencies);
+    return measured == count ? 0 : 1;
 }
 
 int main(int argc, char *argv[]) {
     int target_cpu = -1;
-    if (argc > 1) {
-        target_cpu = atoi(argv[1]);
+    int huge_text = 0;
+    int itlb = 0;
+    int matrix = -1; // -1 — обычный замер, 1 — все ядра одновременно, 0 — по очереди
+    const Workload* selected[WORKLOAD_COUNT];
+    int selected_count = 0;
+    size_t working_set = WORKLOAD_DEFAULT_WORKING_SET;
+    int opt;
+    while ((opt = getopt(argc, argv, "HIM:w:W:")) != -1) {
+        switch (opt) {
+        case 'H': huge_text = 1; break;
+#ifdef JITTER_ITLB
+        case 'I': itlb = 1; break;
+#endif
+        case 'w':
+            selected_count = 0;
+            for (char* name = strtok(optarg, ","); name; name = strtok(NULL, ",")) {
+                if (strcmp(name, "all") == 0) {
+                    for (int i = 0; i < WORKLOAD_COUNT; ++i) selected[i] = &workloads[i];
+                    selected_count = WORKLOAD_COUNT;
+                    break;
+                }
+                const Workload* workload = workload_find(name);
+                if (!workload) {
+                    fprintf(stderr, "Unknown workload: %s\n", name);
+                    return 1;
+                }
+                if (selected_count < WORKLOAD_COUNT) selected[selected_count++] = workload;
+            }
+            break;
+        case 'W': working_set = (size_t)strtoul(optarg, NULL, 10) * 1024; break;
+        case 'M':
+            if (strcmp(optarg, "par") == 0) {
+                matrix = 1;
+                break;
+            }
+            if (strcmp(optarg, "seq") == 0) {
+                matrix = 0;
+                break;
+            }
+            /* fall through */
+        default:
+            fprintf(stderr, "Usage: %s [-H]" ITLB_USAGE " [-M par|seq] [-w kernel,...|all] [-W KB] [cpu]\n"
+                            "  -H  remap program text onto huge pages at startup\n"
+#ifdef JITTER_ITLB
+                            "  -I  compare iTLB misses and latency of a large-code loop before/after remap\n"
+#endif
+                            "  -M  per-CPU jitter matrix on every allowed CPU, all at once (par) or one by one (seq)\n"
+                            "  -w  workload kernels, one jitter row per kernel (-M uses the first)\n"
+                            "  -W  working set of stream/chase/mixed in KB (default %d)\n"
+                            "Kernels:\n",
+                    argv[0], WORKLOAD_DEFAULT_WORKING_SET / 1024);
+            for (int i = 0; i < WORKLOAD_COUNT; ++i) {
+                fprintf(stderr, "  %-8s %s\n", workloads[i].name, workloads[i].description);
+            }
+            return 1;
+        }
+    }
+    if (optind < argc && matrix < 0) {
+        target_cpu = atoi(argv[optind]);
         printf("Target CPU specified: %d\n", target_cpu);
     }
 
+    // Перенос кода до mlockall: новое отображение блокируется вместе с остальной памятью
+    if (huge_text && !itlb) {
+        HugeTextInfo info;
+        if (hugetext_remap(&info) != 0) {
+            perror("WARNING: hugetext_remap failed");
+        } else {
+            printf("Text remapped onto huge pages: %zu KB (%s)\n",
+                   info.huge_bytes / 1024, hugetext_backing_name(info.backing));
+        }
+    }
+
     /* --- ЗАДАНИЕ 2: УСТАНОВКА CPU AFFINITY --- */
     if (target_cpu != -1) {
         // Создать и инициализировать маску CPU
@@ -51,36 +399,51 @@ int main(int argc, char *argv[]) {
     }
     printf("Scheduler policy set to SCHED_FIFO with priority %d\n", sp.sched_priority);
 
-    long long latencies[NUM_ITERATIONS];
-    long long min_latency = -1, max_latency = 0, total_latency = 0;
+    // Заблокировать память и прогреть стек и кучу, чтобы замеры не включали page faults.
+    // Стек потоков уменьшен, чтобы MCL_FUTURE не блокировал по 8 МБ на каждое ядро
+    RtMemOptions mem_opts = { .thread_stack_size = CORE_STACK_SIZE };
+    if (rtmem_init(&mem_opts) != 0) {
+        perror("WARNING: mlockall failed");
+    } else {
+        printf("Process memory locked, stack and heap prefaulted\n");
+    }
+    // Проверка перед циклом: недостающие страницы блокируются и заполняются
+    if (memaudit_run(MEMAUDIT_FIX | MEMAUDIT_QUIET, stdout, NULL) != 0) {
+        printf("WARNING: memory audit found ranges that could not be locked\n");
+    }
 
-    printf("Starting benchmark...\n");
-    for (int i = 0; i < NUM_ITERATIONS; ++i) {
-        struct timespec start, end;
-        clock_gettime(CLOCK_MONOTONIC, &start);
-        
-        work_function();
-        
-        clock_gettime(CLOCK_MONOTONIC, &end);
-        latencies[i] = timespec_diff_ns(start, end);
+    long long latencies[NUM_ITERATIONS];
+    LatencyStats stats;
 
-        if (min_latency == -1 || latencies[i] < min_latency) {
-            min_latency = latencies[i];
-        }
-        if (latencies[i] > max_latency) {
-            max_latency = latencies[i];
-        }
-        total_latency += latencies[i];
+    struct timespec warmup;
+    clock_gettime(CLOCK_MONOTONIC, &warmup);
+#ifdef JITTER_ITLB
+    if (itlb) {
+        benchmark_itlb(latencies);
+        return 0;
+    }
+#endif
+    if (matrix >= 0) {
+        return benchmark_matrix(matrix, selected_count ? selected[0] : &workloads[0], working_set);
+    }
+    if (selected_count) {
+        return benchmark_workloads(selected, selected_count, working_set, latencies);
     }
 
-    double avg_latency = (double)total_latency / NUM_ITERATIONS;
-    long long jitter = max_latency - min_latency;
+    printf("Starting benchmark...\n");
+    struct rusage usage_before, usage_after;
+    getrusage(RUSAGE_SELF, &usage_before);
+    run_loop(workloads[0].run, NULL, latencies, &stats);
+    getrusage(RUSAGE_SELF, &usage_after);
 
     printf("\n--- Benchmark Results ---\n");
-    printf("Min latency:    %lld ns\n", min_latency);
-    printf("Max latency:    %lld ns\n", max_latency);
-    printf("Avg latency:    %.2f ns\n", avg_latency);
-    printf("Jitter (max-min): %lld ns\n", jitter);
+    printf("Min latency:    %lld ns\n", stats.min);
+    printf("Max latency:    %lld ns\n", stats.max);
+    printf("Avg latency:    %.2f ns\n", stats.avg);
+    printf("P99 latency:    %lld ns\n", stats.p99);
+    printf("Jitter (max-min): %lld ns\n", stats.max - stats.min);
+    printf("Page faults:    %ld minor, %ld major\n",
+           usage_after.ru_minflt - usage_before.ru_minflt, usage_after.ru_majflt - usage_before.ru_majflt);
 
     return 0;
 }
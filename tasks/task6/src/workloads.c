@@ -0,0 +1,250 @@
+#define _GNU_SOURCE
+#include "workloads.h"
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define FP_ITERATIONS 100000
+#define SIMD_LENGTH 2048    // Два массива double по 16 КБ — помещаются в L1
+#define SIMD_PASSES 500
+#define CHASE_STEPS 20000
+#define CACHE_LINE 64
+
+typedef double v4d __attribute__((vector_size(32)));
+
+static volatile double workload_sink;
+
+// --- fp ---
+
+static double fp_kernel(int iterations) {
+    double result = 0.0;
+    for (int i = 0; i < iterations; ++i) {
+        result += sin(i) * cos(i);
+    }
+    return result;
+}
+
+static void fp_run(void* ctx) {
+    (void)ctx;
+    // Без записи результата компилятор убирает цикл целиком
+    workload_sink = fp_kernel(FP_ITERATIONS);
+}
+
+// --- simd ---
+
+typedef struct {
+    v4d* x;
+    v4d* y;
+} Simd;
+
+static void simd_destroy(void* ctx) {
+    Simd* s = (Simd*)ctx;
+    if (!s) return;
+    free(s->x);
+    free(s->y);
+    free(s);
+}
+
+static void* simd_create(size_t working_set) {
+    (void)working_set;
+    Simd* s = (Simd*)calloc(1, sizeof(Simd));
+    if (!s) return NULL;
+    if (posix_memalign((void**)&s->x, sizeof(v4d), SIMD_LENGTH * sizeof(double)) != 0 ||
+        posix_memalign((void**)&s->y, sizeof(v4d), SIMD_LENGTH * sizeof(double)) != 0) {
+        simd_destroy(s);
+        return NULL;
+    }
+    double* x = (double*)s->x;
+    double* y = (double*)s->y;
+    for (int i = 0; i < SIMD_LENGTH; ++i) {
+        x[i] = (double)i / SIMD_LENGTH;
+        y[i] = 0.0;
+    }
+    return s;
+}
+
+static void simd_passes(Simd* s, int passes) {
+    // y сходится к x / (1 - a) и не переполняется при повторных вызовах
+    const v4d a = {0.999, 0.999, 0.999, 0.999};
+    for (int pass = 0; pass < passes; ++pass) {
+        for (int i = 0; i < SIMD_LENGTH / 4; ++i) {
+            s->y[i] = a * s->y[i] + s->x[i];
+        }
+    }
+}
+
+static void simd_run(void* ctx) {
+    simd_passes((Simd*)ctx, SIMD_PASSES);
+}
+
+// --- stream ---
+
+typedef struct {
+    double* a;
+    double* b;
+    double* c;
+    size_t count;   // Элементов в каждом массиве
+    size_t offset;  // Начало следующей порции для mixed
+} Stream;
+
+static void stream_destroy(void* ctx) {
+    Stream* s = (Stream*)ctx;
+    if (!s) return;
+    free(s->a);
+    free(s->b);
+    free(s->c);
+    free(s);
+}
+
+static void* stream_create(size_t working_set) {
+    Stream* s = (Stream*)calloc(1, sizeof(Stream));
+    if (!s) return NULL;
+    s->count = working_set / 3 / sizeof(double);
+    if (s->count == 0) s->count = 1;
+    s->a = (double*)malloc(s->count * sizeof(double));
+    s->b = (double*)malloc(s->count * sizeof(double));
+    s->c = (double*)malloc(s->count * sizeof(double));
+    if (!s->a || !s->b || !s->c) {
+        stream_destroy(s);
+        return NULL;
+    }
+    for (size_t i = 0; i < s->count; ++i) {
+        s->a[i] = 0.0;
+        s->b[i] = 1.0;
+        s->c[i] = 2.0;
+    }
+    return s;
+}
+
+static void stream_range(Stream* s, size_t from, size_t count) {
+    const double scalar = 3.0;
+    for (size_t i = from; i < from + count; ++i) {
+        s->a[i] = s->b[i] + scalar * s->c[i];
+    }
+}
+
+static void stream_run(void* ctx) {
+    Stream* s = (Stream*)ctx;
+    stream_range(s, 0, s->count);
+}
+
+// --- chase ---
+
+typedef struct {
+    void** nodes;   // Узел — одна кэш-линия, первое слово указывает на следующий
+    void** pos;
+} Chase;
+
+static void chase_destroy(void* ctx) {
+    Chase* c = (Chase*)ctx;
+    if (!c) return;
+    free(c->nodes);
+    free(c);
+}
+
+static void* chase_create(size_t working_set) {
+    size_t stride = CACHE_LINE / sizeof(void*);
+    size_t count = working_set / CACHE_LINE;
+    if (count < 2) count = 2;
+    Chase* c = (Chase*)calloc(1, sizeof(Chase));
+    size_t* order = (size_t*)malloc(count * sizeof(size_t));
+    if (c) c->nodes = (void**)calloc(count * stride, sizeof(void*));
+    if (!c || !order || !c->nodes) {
+        free(order);
+        chase_destroy(c);
+        return NULL;
+    }
+
+    // Один цикл через все узлы в случайном порядке (алгоритм Саттоло):
+    // аппаратная предвыборка не угадывает следующий адрес
+    unsigned seed = 2463534242u;
+    for (size_t i = 0; i < count; ++i) order[i] = i;
+    for (size_t i = count - 1; i > 0; --i) {
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        size_t j = seed % i;
+        size_t tmp = order[i];
+        order[i] = order[j];
+        order[j] = tmp;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        c->nodes[order[i] * stride] = &c->nodes[order[(i + 1) % count] * stride];
+    }
+    free(order);
+    c->pos = c->nodes;
+    return c;
+}
+
+static void chase_steps(Chase* c, int steps) {
+    void** p = c->pos;
+    for (int i = 0; i < steps; ++i) {
+        p = (void**)*p;
+    }
+    // Следующий вызов продолжает обход с того же места
+    c->pos = p;
+}
+
+static void chase_run(void* ctx) {
+    chase_steps((Chase*)ctx, CHASE_STEPS);
+}
+
+// --- mixed ---
+
+typedef struct {
+    Simd* simd;
+    Stream* stream;
+    Chase* chase;
+} Mixed;
+
+static void mixed_destroy(void* ctx) {
+    Mixed* m = (Mixed*)ctx;
+    if (!m) return;
+    simd_destroy(m->simd);
+    stream_destroy(m->stream);
+    chase_destroy(m->chase);
+    free(m);
+}
+
+// Рабочий набор делится между stream и chase поровну
+static void* mixed_create(size_t working_set) {
+    Mixed* m = (Mixed*)calloc(1, sizeof(Mixed));
+    if (!m) return NULL;
+    m->simd = (Simd*)simd_create(working_set);
+    m->stream = (Stream*)stream_create(working_set / 2);
+    m->chase = (Chase*)chase_create(working_set / 2);
+    if (!m->simd || !m->stream || !m->chase) {
+        mixed_destroy(m);
+        return NULL;
+    }
+    return m;
+}
+
+// По четверти каждой нагрузки; stream проходит свой набор за четыре вызова
+static void mixed_run(void* ctx) {
+    Mixed* m = (Mixed*)ctx;
+    workload_sink = fp_kernel(FP_ITERATIONS / 4);
+    simd_passes(m->simd, SIMD_PASSES / 4);
+    Stream* s = m->stream;
+    size_t part = (s->count + 3) / 4;
+    if (part > s->count - s->offset) part = s->count - s->offset;
+    stream_range(s, s->offset, part);
+    s->offset = s->offset + part < s->count ? s->offset + part : 0;
+    chase_steps(m->chase, CHASE_STEPS / 4);
+}
+
+const Workload workloads[WORKLOAD_COUNT] = {
+    {"fp", "scalar sin/cos loop", NULL, fp_run, NULL},
+    {"simd", "vector a*y+x over L1-resident arrays", simd_create, simd_run, simd_destroy},
+    {"stream", "streaming triad a=b+s*c over the working set", stream_create, stream_run, stream_destroy},
+    {"chase", "dependent pointer chase over the working set", chase_create, chase_run, chase_destroy},
+    {"mixed", "a quarter of each of the above", mixed_create, mixed_run, mixed_destroy},
+};
+
+const Workload* workload_find(const char* name) {
+    for (int i = 0; i < WORKLOAD_COUNT; ++i) {
+        if (strcmp(workloads[i].name, name) == 0) return &workloads[i];
+    }
+    return NULL;
+}
@@ -0,0 +1,51 @@
+#ifndef WORKLOADS_H
+#define WORKLOADS_H
+
+#include <stddef.h>
+
+/*
+ * Набор рабочих нагрузок для замера джиттера.
+ *
+ * Реальные задачи часто упираются в память, и их джиттер зависит от кэшей
+ * и TLB, которые вычислительный цикл не задевает. Каждая нагрузка — это
+ * один вызов run(), время которого измеряется, и необязательное состояние
+ * (буферы), которое create() выделяет и прогревает до начала замеров:
+ *   fp     — скалярные sin/cos, исходная нагрузка задания;
+ *   simd   — y = a * y + x над векторами в L1 (векторные расширения GCC);
+ *   stream — потоковая триада a = b + s * c по всему рабочему набору;
+ *   chase  — обход случайного цикла указателей по рабочему набору, каждый
+ *            шаг зависит от предыдущего и промахивается мимо кэша и TLB;
+ *   mixed  — понемногу каждой из нагрузок выше за один вызов.
+ */
+
+/** Рабочий набор stream и chase по умолчанию. */
+#define WORKLOAD_DEFAULT_WORKING_SET (32 * 1024 * 1024)
+
+/** Описание нагрузки. */
+typedef struct {
+    const char* name;
+    const char* description;
+    /** Выделяет и прогревает состояние на working_set байт (NULL — состояние не нужно).
+     *  Возвращает NULL при нехватке памяти. */
+    void* (*create)(size_t working_set);
+    /** Одна измеряемая порция работы. */
+    void (*run)(void* ctx);
+    /** Освобождает состояние (NULL — нечего освобождать). */
+    void (*destroy)(void* ctx);
+} Workload;
+
+/** Число нагрузок. */
+#define WORKLOAD_COUNT 5
+
+/** Все нагрузки в порядке вывода; первая (fp) используется по умолчанию. */
+extern const Workload workloads[WORKLOAD_COUNT];
+
+/**
+ * @brief Ищет нагрузку по имени.
+ *
+ * @param name Имя нагрузки.
+ * @return Указатель на описание или NULL, если такой нет.
+ */
+const Workload* workload_find(const char* name);
+
+#endif // WORKLOADS_H